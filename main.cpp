@@ -3,625 +3,9659 @@
 #include <vector>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <cstring>
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <ctime>
 #include <limits>
+#include <iomanip>
+#include <string_view>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <list>
+#include <queue>
+#include <tuple>
+#include <bitset>
+#include <regex>
+#include <iterator>
+#include <csignal>
+#include <future>
 #include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <termios.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <pwd.h>
+#include <grp.h>
+#include <dirent.h>
+#include <climits>
 #include <unistd.h>
+#include <zlib.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 namespace fs = std::filesystem;
 
-class FileExplorer {
+struct LinuxDirent64 {
+    ino64_t d_ino;
+    off64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+enum class Counter { Syscalls, Entries, Bytes };
+
+class Instrumentation {
+public:
+    static constexpr size_t counterCount = 3;
+    static constexpr size_t eventLimitPerThread = 1 << 20;
+
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    static void setEnabled(bool on) { active.store(on, std::memory_order_relaxed); }
+
+    static void add(Counter counter, uint64_t amount = 1) {
+        if (!enabled()) return;
+        local().counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    static void record(const char* name, std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end) {
+        ThreadData& data = local();
+        std::lock_guard<std::mutex> guard(data.eventLock);
+        if (data.events.size() >= eventLimitPerThread) {
+            data.dropped++;
+            return;
+        }
+        data.events.push_back(Event{name, nanosSinceEpoch(start), nanosSinceEpoch(end) - nanosSinceEpoch(start)});
+    }
+
+    static uint64_t total(Counter counter) {
+        std::lock_guard<std::mutex> guard(registryLock);
+        uint64_t sum = 0;
+        for (auto& data : threads) sum += data->counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    static void reset() {
+        std::lock_guard<std::mutex> guard(registryLock);
+        for (auto& data : threads) {
+            for (auto& counter : data->counters) counter.store(0, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> eventGuard(data->eventLock);
+            data->events.clear();
+            data->dropped = 0;
+        }
+    }
+
+    static std::string summary() {
+        struct Totals {
+            uint64_t calls = 0;
+            uint64_t nanos = 0;
+            uint64_t maxNanos = 0;
+        };
+        std::map<std::string, Totals> byName;
+        uint64_t counters[counterCount] = {};
+        size_t threadCount = 0;
+        uint64_t dropped = 0;
+        {
+            std::lock_guard<std::mutex> guard(registryLock);
+            for (auto& data : threads) {
+                for (size_t i = 0; i < counterCount; i++) counters[i] += data->counters[i].load(std::memory_order_relaxed);
+                std::lock_guard<std::mutex> eventGuard(data->eventLock);
+                if (!data->events.empty()) threadCount++;
+                dropped += data->dropped;
+                for (const auto& event : data->events) {
+                    Totals& totals = byName[event.name];
+                    totals.calls++;
+                    totals.nanos += event.duration;
+                    totals.maxNanos = std::max(totals.maxNanos, event.duration);
+                }
+            }
+        }
+
+        std::string out;
+        char line[256];
+        snprintf(line, sizeof(line), "%-32s %10s %12s %12s %12s\n", "Timer", "Calls", "Total ms", "Mean us", "Max us");
+        out += line;
+        for (const auto& [name, totals] : byName) {
+            snprintf(line, sizeof(line), "%-32s %10llu %12.3f %12.1f %12.1f\n", name.c_str(),
+                     static_cast<unsigned long long>(totals.calls), totals.nanos / 1e6,
+                     totals.nanos / 1e3 / static_cast<double>(totals.calls), totals.maxNanos / 1e3);
+            out += line;
+        }
+        snprintf(line, sizeof(line), "\nSyscalls: %llu   Entries: %llu   Bytes: %llu   Threads: %zu\n",
+                 static_cast<unsigned long long>(counters[0]), static_cast<unsigned long long>(counters[1]),
+                 static_cast<unsigned long long>(counters[2]), threadCount);
+        out += line;
+        if (dropped > 0) out += "Dropped " + std::to_string(dropped) + " event(s) over the per-thread limit\n";
+        return out;
+    }
+
+    static bool exportChromeTrace(const fs::path& file) {
+        std::ofstream out(file, std::ios::trunc);
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        uint64_t lastTimestamp = 0;
+        uint64_t counters[counterCount] = {};
+        {
+            std::lock_guard<std::mutex> guard(registryLock);
+            for (auto& data : threads) {
+                for (size_t i = 0; i < counterCount; i++) counters[i] += data->counters[i].load(std::memory_order_relaxed);
+                std::lock_guard<std::mutex> eventGuard(data->eventLock);
+                for (const auto& event : data->events) {
+                    char buffer[256];
+                    snprintf(buffer, sizeof(buffer),
+                             "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}",
+                             first ? "" : ",", event.name, event.start / 1e3, event.duration / 1e3,
+                             static_cast<int>(getpid()), data->id);
+                    out << buffer;
+                    first = false;
+                    lastTimestamp = std::max(lastTimestamp, event.start + event.duration);
+                }
+            }
+        }
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer),
+                 "%s\n{\"name\":\"counters\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,"
+                 "\"args\":{\"syscalls\":%llu,\"entries\":%llu,\"bytes\":%llu}}",
+                 first ? "" : ",", lastTimestamp / 1e3, static_cast<int>(getpid()),
+                 static_cast<unsigned long long>(counters[0]), static_cast<unsigned long long>(counters[1]),
+                 static_cast<unsigned long long>(counters[2]));
+        out << buffer << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+
 private:
-    fs::path currentPath;
+    struct Event {
+        const char* name;
+        uint64_t start;
+        uint64_t duration;
+    };
 
-    void clearScreen() {
-        std::cout << "\033[2J\033[1;1H";
+    struct ThreadData {
+        unsigned id = 0;
+        std::atomic<uint64_t> counters[counterCount] = {};
+        std::mutex eventLock;
+        std::vector<Event> events;
+        uint64_t dropped = 0;
+    };
+
+    static inline std::atomic<bool> active{false};
+    static inline std::mutex registryLock;
+    static inline std::vector<std::shared_ptr<ThreadData>> threads;
+    static inline const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    static uint64_t nanosSinceEpoch(std::chrono::steady_clock::time_point when) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(when - epoch).count());
     }
 
-    void displayHeader() {
-        std::cout << "\n╔════════════════════════════════════════════════════════════════╗\n";
-        std::cout << "║           CONSOLE-BASED FILE EXPLORER APPLICATION              ║\n";
-        std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
-        std::cout << "Current Directory: " << currentPath << "\n";
-        std::cout << "================================================================\n\n";
+    static ThreadData& local() {
+        thread_local std::shared_ptr<ThreadData> data = [] {
+            auto created = std::make_shared<ThreadData>();
+            std::lock_guard<std::mutex> guard(registryLock);
+            created->id = static_cast<unsigned>(threads.size() + 1);
+            threads.push_back(created);
+            return created;
+        }();
+        return *data;
     }
+};
 
-    void displayMenu() {
-        std::cout << "\n┌─────────────────── MAIN MENU ───────────────────┐\n";
-        std::cout << "│  1.  List Files and Directories                 │\n";
-        std::cout << "│  2.  Change Directory                            │\n";
-        std::cout << "│  3.  Create New File                             │\n";
-        std::cout << "│  4.  Create New Directory                        │\n";
-        std::cout << "│  5.  Copy File                                   │\n";
-        std::cout << "│  6.  Move File                                   │\n";
-        std::cout << "│  7.  Delete File                                 │\n";
-        std::cout << "│  8.  Delete Directory                            │\n";
-        std::cout << "│  9.  Search Files                                │\n";
-        std::cout << "│  10. View File Permissions                       │\n";
-        std::cout << "│  11. Change File Permissions                     │\n";
-        std::cout << "│  12. View File Details                           │\n";
-        std::cout << "│  0.  Exit                                        │\n";
-        std::cout << "└─────────────────────────────────────────────────┘\n";
-        std::cout << "\nEnter your choice: ";
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name) : name(Instrumentation::enabled() ? name : nullptr) {
+        if (this->name) start = std::chrono::steady_clock::now();
     }
 
-    std::string getPermissionString(fs::perms p) {
-        std::string result;
-        result += (fs::perms::none != (p & fs::perms::owner_read)) ? "r" : "-";
-        result += (fs::perms::none != (p & fs::perms::owner_write)) ? "w" : "-";
-        result += (fs::perms::none != (p & fs::perms::owner_exec)) ? "x" : "-";
-        result += (fs::perms::none != (p & fs::perms::group_read)) ? "r" : "-";
-        result += (fs::perms::none != (p & fs::perms::group_write)) ? "w" : "-";
-        result += (fs::perms::none != (p & fs::perms::group_exec)) ? "x" : "-";
-        result += (fs::perms::none != (p & fs::perms::others_read)) ? "r" : "-";
-        result += (fs::perms::none != (p & fs::perms::others_write)) ? "w" : "-";
-        result += (fs::perms::none != (p & fs::perms::others_exec)) ? "x" : "-";
-        return result;
+    ~ScopedTimer() {
+        if (name) Instrumentation::record(name, start, std::chrono::steady_clock::now());
     }
 
-    std::string formatFileSize(uintmax_t size) {
-        const char* units[] = {"B", "KB", "MB", "GB", "TB"};
-        int unitIndex = 0;
-        double fileSize = static_cast<double>(size);
-        
-        while (fileSize >= 1024.0 && unitIndex < 4) {
-            fileSize /= 1024.0;
-            unitIndex++;
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* name;
+    std::chrono::steady_clock::time_point start;
+};
+
+struct WalkEntry {
+    const std::string& path;
+    const char* name;
+    unsigned char type;
+    ino_t inode;
+    int dirFd;
+    int depth;
+};
+
+inline size_t findLiteralScalar(std::string_view haystack, std::string_view needle) {
+    return haystack.find(needle);
+}
+
+#if defined(__x86_64__)
+inline size_t findLiteralSse2(std::string_view haystack, std::string_view needle) {
+    const size_t n = needle.size();
+    if (n == 0) return 0;
+    if (haystack.size() < n) return std::string_view::npos;
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    const char* data = haystack.data();
+    size_t i = 0;
+    for (; i + n - 1 + 16 <= haystack.size(); i += 16) {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (std::memcmp(data + i + bit + 1, needle.data() + 1, n > 2 ? n - 2 : 0) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    size_t rest = haystack.substr(i).find(needle);
+    return rest == std::string_view::npos ? rest : i + rest;
+}
+
+__attribute__((target("avx2")))
+inline size_t findLiteralAvx2(std::string_view haystack, std::string_view needle) {
+    const size_t n = needle.size();
+    if (n == 0) return 0;
+    if (haystack.size() < n) return std::string_view::npos;
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[n - 1]);
+    const char* data = haystack.data();
+    size_t i = 0;
+    for (; i + n - 1 + 32 <= haystack.size(); i += 32) {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + n - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (std::memcmp(data + i + bit + 1, needle.data() + 1, n > 2 ? n - 2 : 0) == 0) return i + bit;
+            mask &= mask - 1;
         }
-        
-        char buffer[50];
-        snprintf(buffer, sizeof(buffer), "%.2f %s", fileSize, units[unitIndex]);
-        return std::string(buffer);
     }
+    size_t rest = findLiteralSse2(haystack.substr(i), needle);
+    return rest == std::string_view::npos ? rest : i + rest;
+}
+#endif
+
+using FindLiteralFunction = size_t (*)(std::string_view, std::string_view);
+
+inline FindLiteralFunction selectFindLiteral() {
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("avx2") ? findLiteralAvx2 : findLiteralSse2;
+#else
+    return findLiteralScalar;
+#endif
+}
+
+inline const FindLiteralFunction findLiteralVector = selectFindLiteral();
+
+inline size_t findLiteral(std::string_view haystack, std::string_view needle) {
+    if (haystack.size() < needle.size() + 16) return findLiteralScalar(haystack, needle);
+    return findLiteralVector(haystack, needle);
+}
+
+enum class MatchMode { Substring, IgnoreCase, Glob, Regex };
 
+class NameMatcher {
 public:
-    FileExplorer() {
-        currentPath = fs::current_path();
+    NameMatcher(std::string pattern, MatchMode mode) : mode(mode), pattern(std::move(pattern)) {
+        if (mode == MatchMode::IgnoreCase) {
+            folded = foldCase(this->pattern);
+        } else if (mode == MatchMode::Glob) {
+            compileGlob();
+        } else if (mode == MatchMode::Regex) {
+            regex = std::regex(this->pattern, std::regex::ECMAScript | std::regex::optimize);
+        }
     }
 
-    void listFiles() {
-        clearScreen();
-        displayHeader();
-        std::cout << "Listing contents of: " << currentPath << "\n\n";
-        
-        std::cout << "┌────────────────────────────────────────────────────────────────────────┐\n";
-        std::cout << "│ Type │ Name                              │ Size         │ Permissions │\n";
-        std::cout << "├────────────────────────────────────────────────────────────────────────┤\n";
-        
-        try {
-            std::vector<fs::directory_entry> entries;
-            for (const auto& entry : fs::directory_iterator(currentPath)) {
-                entries.push_back(entry);
-            }
-            
-            std::sort(entries.begin(), entries.end(), 
-                [](const fs::directory_entry& a, const fs::directory_entry& b) {
-                    if (a.is_directory() != b.is_directory())
-                        return a.is_directory();
-                    return a.path().filename() < b.path().filename();
-                });
-            
-            for (const auto& entry : entries) {
-                std::string type = entry.is_directory() ? "[DIR]" : "[FILE]";
-                std::string name = entry.path().filename().string();
-                std::string size = entry.is_directory() ? "---" : formatFileSize(entry.file_size());
-                std::string perms = getPermissionString(entry.status().permissions());
-                
-                printf("│ %-4s │ %-33s │ %-12s │ %-11s │\n", 
-                       type.c_str(), 
-                       name.substr(0, 33).c_str(), 
-                       size.c_str(), 
-                       perms.c_str());
-            }
-            
-            std::cout << "└────────────────────────────────────────────────────────────────────────┘\n";
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "Error: " << e.what() << "\n";
+    static const char* modeName(MatchMode mode) {
+        switch (mode) {
+            case MatchMode::Substring: return "substring";
+            case MatchMode::IgnoreCase: return "case-insensitive";
+            case MatchMode::Glob: return "glob";
+            case MatchMode::Regex: return "regex";
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
+        return "unknown";
     }
 
-    void changeDirectory() {
-        clearScreen();
-        displayHeader();
-        std::cout << "Change Directory\n";
-        std::cout << "────────────────\n\n";
-        std::cout << "Enter directory path (or '..' for parent, '~' for home): ";
-        
-        std::string newPath;
-        std::getline(std::cin, newPath);
-        
-        try {
-            if (newPath == "~") {
-                currentPath = fs::path(getenv("HOME"));
-            } else if (newPath == "..") {
-                if (currentPath.has_parent_path()) {
-                    currentPath = currentPath.parent_path();
-                }
-            } else {
-                fs::path targetPath = newPath;
-                if (!targetPath.is_absolute()) {
-                    targetPath = currentPath / newPath;
-                }
-                
-                if (fs::exists(targetPath) && fs::is_directory(targetPath)) {
-                    currentPath = fs::canonical(targetPath);
-                } else {
-                    std::cout << "\nError: Directory does not exist!\n";
-                }
+    MatchMode matchMode() const { return mode; }
+    const std::string& text() const { return pattern; }
+
+    bool matches(std::string_view name) const {
+        switch (mode) {
+            case MatchMode::Substring:
+                return findLiteral(name, pattern) != std::string_view::npos;
+            case MatchMode::IgnoreCase: {
+                thread_local std::string buffer;
+                foldCaseInto(name, buffer);
+                return findLiteral(buffer, folded) != std::string_view::npos;
             }
-            std::cout << "\nCurrent directory: " << currentPath << "\n";
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError: " << e.what() << "\n";
+            case MatchMode::Glob:
+                return matchGlob(name);
+            case MatchMode::Regex:
+                return std::regex_search(name.begin(), name.end(), regex);
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
+        return false;
     }
 
-    void createFile() {
-        clearScreen();
-        displayHeader();
-        std::cout << "Create New File\n";
-        std::cout << "───────────────\n\n";
-        std::cout << "Enter file name: ";
-        
-        std::string fileName;
-        std::getline(std::cin, fileName);
-        
-        try {
-            fs::path filePath = currentPath / fileName;
-            
-            if (fs::exists(filePath)) {
-                std::cout << "\nError: File already exists!\n";
-            } else {
-                std::ofstream file(filePath);
-                if (file.is_open()) {
-                    file.close();
-                    std::cout << "\nFile created successfully: " << filePath << "\n";
-                } else {
-                    std::cout << "\nError: Could not create file!\n";
+    static std::string foldCase(std::string_view text) {
+        std::string out;
+        foldCaseInto(text, out);
+        return out;
+    }
+
+private:
+    struct GlobToken {
+        enum Kind { Literal, AnyChar, AnyRun, Class } kind;
+        std::string literal;
+        std::bitset<256> members;
+    };
+
+    MatchMode mode;
+    std::string pattern;
+    std::string folded;
+    std::vector<GlobToken> tokens;
+    std::regex regex;
+
+    static void foldCaseInto(std::string_view text, std::string& out) {
+        out.resize(text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= 'A' && c <= 'Z') {
+                out[i] = static_cast<char>(c + 32);
+            } else if ((c == 0xC3 || c == 0xCE || c == 0xD0) && i + 1 < text.size()) {
+                unsigned char next = static_cast<unsigned char>(text[i + 1]);
+                out[i] = static_cast<char>(c);
+                if (c == 0xC3 && next >= 0x80 && next <= 0x9E && next != 0x97) {
+                    next += 0x20;
+                } else if (c == 0xCE && next >= 0x91 && next <= 0xA9 && next != 0xA2) {
+                    if (next >= 0xA0) {
+                        out[i] = static_cast<char>(0xCF);
+                        next -= 0x20;
+                    } else {
+                        next += 0x20;
+                    }
+                } else if (c == 0xD0 && next >= 0x90 && next <= 0xAF) {
+                    if (next >= 0xA0) {
+                        out[i] = static_cast<char>(0xD1);
+                        next -= 0x20;
+                    } else {
+                        next += 0x20;
+                    }
                 }
+                out[++i] = static_cast<char>(next);
+            } else {
+                out[i] = static_cast<char>(c);
             }
-        } catch (const std::exception& e) {
-            std::cout << "\nError: " << e.what() << "\n";
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
     }
 
-    void createDirectory() {
-        clearScreen();
-        displayHeader();
-        std::cout << "Create New Directory\n";
-        std::cout << "────────────────────\n\n";
-        std::cout << "Enter directory name: ";
-        
-        std::string dirName;
-        std::getline(std::cin, dirName);
-        
-        try {
-            fs::path dirPath = currentPath / dirName;
-            
-            if (fs::exists(dirPath)) {
-                std::cout << "\nError: Directory already exists!\n";
-            } else {
-                if (fs::create_directory(dirPath)) {
-                    std::cout << "\nDirectory created successfully: " << dirPath << "\n";
-                } else {
-                    std::cout << "\nError: Could not create directory!\n";
+    void compileGlob() {
+        for (size_t i = 0; i < pattern.size(); i++) {
+            char c = pattern[i];
+            if (c == '*') {
+                if (tokens.empty() || tokens.back().kind != GlobToken::AnyRun) tokens.push_back({GlobToken::AnyRun, {}, {}});
+            } else if (c == '?') {
+                tokens.push_back({GlobToken::AnyChar, {}, {}});
+            } else if (c == '[' && pattern.find(']', i + 2) != std::string::npos) {
+                GlobToken token{GlobToken::Class, {}, {}};
+                size_t j = i + 1;
+                bool negate = pattern[j] == '!' || pattern[j] == '^';
+                if (negate) j++;
+                size_t start = j;
+                for (; j < pattern.size() && (pattern[j] != ']' || j == start); j++) {
+                    unsigned char low = static_cast<unsigned char>(pattern[j]);
+                    unsigned char high = low;
+                    if (j + 2 < pattern.size() && pattern[j + 1] == '-' && pattern[j + 2] != ']') {
+                        high = static_cast<unsigned char>(pattern[j + 2]);
+                        j += 2;
+                    }
+                    for (unsigned v = low; v <= high; v++) token.members.set(v);
                 }
+                if (negate) token.members.flip();
+                tokens.push_back(std::move(token));
+                i = j;
+            } else {
+                if (c == '\\' && i + 1 < pattern.size()) c = pattern[++i];
+                if (tokens.empty() || tokens.back().kind != GlobToken::Literal) tokens.push_back({GlobToken::Literal, {}, {}});
+                tokens.back().literal += c;
             }
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError: " << e.what() << "\n";
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
     }
 
-    void copyFile() {
-        clearScreen();
-        displayHeader();
-        std::cout << "Copy File\n";
-        std::cout << "─────────\n\n";
-        
-        std::string source, destination;
-        
-        std::cout << "Enter source file path: ";
-        std::getline(std::cin, source);
-        
-        std::cout << "Enter destination file path: ";
-        std::getline(std::cin, destination);
-        
-        try {
-            fs::path sourcePath = currentPath / source;
-            fs::path destPath = currentPath / destination;
-            
-            if (!fs::exists(sourcePath)) {
-                std::cout << "\nError: Source file does not exist!\n";
-            } else if (fs::is_directory(sourcePath)) {
-                std::cout << "\nError: Source is a directory. Use file path only.\n";
-            } else {
-                fs::copy_file(sourcePath, destPath, fs::copy_options::overwrite_existing);
-                std::cout << "\nFile copied successfully!\n";
-                std::cout << "From: " << sourcePath << "\n";
-                std::cout << "To:   " << destPath << "\n";
+    bool matchGlob(std::string_view name) const {
+        size_t t = 0;
+        size_t n = 0;
+        size_t starToken = std::string::npos;
+        size_t starName = 0;
+        while (n < name.size() || t < tokens.size()) {
+            if (t < tokens.size()) {
+                const GlobToken& token = tokens[t];
+                switch (token.kind) {
+                    case GlobToken::AnyRun:
+                        starToken = t++;
+                        starName = n;
+                        continue;
+                    case GlobToken::AnyChar:
+                        if (n < name.size()) {
+                            t++;
+                            n++;
+                            continue;
+                        }
+                        break;
+                    case GlobToken::Class:
+                        if (n < name.size() && token.members.test(static_cast<unsigned char>(name[n]))) {
+                            t++;
+                            n++;
+                            continue;
+                        }
+                        break;
+                    case GlobToken::Literal:
+                        if (name.compare(n, token.literal.size(), token.literal) == 0) {
+                            t++;
+                            n += token.literal.size();
+                            continue;
+                        }
+                        break;
+                }
             }
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError: " << e.what() << "\n";
+            if (starToken == std::string::npos || starName >= name.size()) return false;
+            t = starToken + 1;
+            n = ++starName;
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
+        return true;
+    }
+};
+
+class ParallelWalker {
+public:
+    using Visitor = std::function<bool(const WalkEntry&)>;
+
+    explicit ParallelWalker(unsigned threadCount = 0)
+        : threadCount(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency())) {}
+
+    unsigned workerCount() const { return threadCount; }
+    uintmax_t errorCount() const { return errors.load(); }
+    uintmax_t directoryCount() const { return directories.load(); }
+
+    void walk(const fs::path& root, const Visitor& visitor) {
+        ScopedTimer timer("walker.walk");
+        queues = std::vector<WorkerQueue>(threadCount);
+        errors = 0;
+        directories = 0;
+        pending = 1;
+        queues[0].tasks.push_back(DirTask{nullptr, root.string(), 0});
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threadCount; i++) {
+            workers.emplace_back([this, i, &visitor] { workerLoop(i, visitor); });
+        }
+        workerLoop(0, visitor);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+private:
+    struct DirHandle {
+        int fd;
+        explicit DirHandle(int fd) : fd(fd) {}
+        ~DirHandle() { close(fd); }
+    };
+
+    struct DirTask {
+        std::shared_ptr<DirHandle> parent;
+        std::string path;
+        int depth;
+    };
+
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<DirTask> tasks;
+    };
+
+    unsigned threadCount;
+    std::vector<WorkerQueue> queues;
+    std::atomic<uintmax_t> pending{0};
+    std::atomic<uintmax_t> errors{0};
+    std::atomic<uintmax_t> directories{0};
+
+    bool popLocal(unsigned self, DirTask& task) {
+        std::lock_guard<std::mutex> guard(queues[self].lock);
+        if (queues[self].tasks.empty()) return false;
+        task = std::move(queues[self].tasks.back());
+        queues[self].tasks.pop_back();
+        return true;
+    }
+
+    bool steal(unsigned self, DirTask& task) {
+        for (unsigned offset = 1; offset < threadCount; offset++) {
+            WorkerQueue& victim = queues[(self + offset) % threadCount];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(unsigned self, const Visitor& visitor) {
+        std::vector<char> buffer(64 * 1024);
+        int idleRounds = 0;
+        while (pending.load() > 0) {
+            DirTask task;
+            if (popLocal(self, task) || steal(self, task)) {
+                idleRounds = 0;
+                processDirectory(self, task, buffer, visitor);
+                pending.fetch_sub(1);
+            } else if (++idleRounds < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    void processDirectory(unsigned self, DirTask& task, std::vector<char>& buffer, const Visitor& visitor) {
+        ScopedTimer timer("walker.directory");
+        const int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (task.depth > 0 ? O_NOFOLLOW : 0);
+        int fd = -1;
+        if (task.parent) {
+            const char* name = task.path.c_str() + task.path.rfind('/') + 1;
+            fd = openat(task.parent->fd, name, flags);
+        }
+        if (fd < 0 && (!task.parent || errno == EMFILE || errno == ENFILE)) {
+            task.parent.reset();
+            fd = open(task.path.c_str(), flags);
+        }
+        if (fd < 0) {
+            errors++;
+            return;
+        }
+        directories++;
+        Instrumentation::add(Counter::Syscalls, 2);
+        auto handle = std::make_shared<DirHandle>(fd);
+        std::string prefix = task.path;
+        if (prefix.empty() || prefix.back() != '/') prefix += '/';
+
+        while (true) {
+            long bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+            Instrumentation::add(Counter::Syscalls);
+            if (bytes < 0) {
+                errors++;
+                break;
+            }
+            if (bytes == 0) break;
+
+            for (long offset = 0; offset < bytes;) {
+                auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+                offset += dirent->d_reclen;
+                const char* name = dirent->d_name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+                unsigned char type = dirent->d_type;
+                if (type == DT_UNKNOWN) {
+                    struct stat st;
+                    if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                        type = IFTODT(st.st_mode);
+                    }
+                }
+
+                Instrumentation::add(Counter::Entries);
+                std::string childPath = prefix + name;
+                WalkEntry entry{childPath, name, type, static_cast<ino_t>(dirent->d_ino), fd, task.depth + 1};
+                bool descend = visitor(entry);
+                if (type == DT_DIR && descend) {
+                    pending.fetch_add(1);
+                    std::lock_guard<std::mutex> guard(queues[self].lock);
+                    queues[self].tasks.push_back(DirTask{handle, std::move(childPath), task.depth + 1});
+                }
+            }
+        }
+    }
+};
+
+class FileIndex {
+public:
+    static constexpr int64_t maxAgeSeconds = 15 * 60;
+
+    struct BuildStats {
+        uintmax_t entries = 0;
+        uintmax_t directoriesRescanned = 0;
+        uintmax_t directoriesReused = 0;
+    };
+
+    FileIndex() = default;
+    FileIndex(const FileIndex&) = delete;
+    FileIndex& operator=(const FileIndex&) = delete;
+    ~FileIndex() { unload(); }
+
+    static fs::path locationFor(const fs::path& root) {
+        const char* cacheHome = getenv("XDG_CACHE_HOME");
+        const char* home = getenv("HOME");
+        fs::path base = cacheHome ? fs::path(cacheHome) : fs::path(home ? home : "/tmp") / ".cache";
+        char name[40];
+        snprintf(name, sizeof(name), "index-%016zx.bin", std::hash<std::string>{}(root.string()));
+        return base / "file_explorer" / name;
+    }
+
+    bool load(const fs::path& root) {
+        unload();
+        int fd = open(locationFor(root).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) return false;
+        base = static_cast<const char*>(mapping);
+        mappedBytes = st.st_size;
+
+        header = reinterpret_cast<const Header*>(base);
+        if (std::memcmp(header->magic, indexMagic, sizeof(indexMagic)) != 0 || !validLayout() ||
+            std::string_view(stringAt(0), header->rootLength) != root.string()) {
+            unload();
+            return false;
+        }
+        return true;
+    }
+
+    void unload() {
+        if (base) munmap(const_cast<char*>(base), mappedBytes);
+        base = nullptr;
+        header = nullptr;
+        mappedBytes = 0;
+    }
+
+    bool isLoaded() const { return base != nullptr; }
+    uintmax_t entryCount() const { return header ? header->entryCount : 0; }
+    int64_t ageSeconds() const { return header ? static_cast<int64_t>(time(nullptr)) - header->builtAt : 0; }
+
+    bool isFresh() const {
+        if (!header || ageSeconds() > maxAgeSeconds) return false;
+        struct stat st;
+        return stat(std::string(stringAt(0), header->rootLength).c_str(), &st) == 0 &&
+               mtimeOf(st) == header->rootMtime;
+    }
+
+    template <typename Callback>
+    void search(const NameMatcher& matcher, Callback&& onMatch) const {
+        ScopedTimer timer("index.search");
+        if (!header) return;
+        const std::string& term = matcher.text();
+        std::string root = withSlash(std::string(stringAt(0), header->rootLength));
+        auto report = [&](uint32_t id) {
+            const Record& record = records()[id];
+            std::string_view name(stringAt(record.pathOffset + record.nameOffset), record.pathLength - record.nameOffset);
+            if (matcher.matches(name)) {
+                onMatch(root + std::string(stringAt(record.pathOffset), record.pathLength), record.type == DT_DIR);
+            }
+        };
+
+        if (matcher.matchMode() != MatchMode::Substring || term.size() < 3) {
+            for (uint32_t id = 0; id < header->entryCount; id++) report(id);
+            return;
+        }
+
+        std::vector<std::pair<const uint32_t*, uint32_t>> lists;
+        for (size_t i = 0; i + 3 <= term.size(); i++) {
+            uint32_t key = trigramKey(term.data() + i);
+            const TrigramSlot* first = trigrams();
+            const TrigramSlot* last = first + header->trigramCount;
+            const TrigramSlot* slot = std::lower_bound(first, last, key,
+                [](const TrigramSlot& s, uint32_t k) { return s.trigram < k; });
+            if (slot == last || slot->trigram != key) return;
+            lists.emplace_back(postings() + slot->first, slot->count);
+        }
+        std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+
+        std::vector<uint32_t> candidates(lists[0].first, lists[0].first + lists[0].second);
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); i++) {
+            std::vector<uint32_t> narrowed;
+            std::set_intersection(candidates.begin(), candidates.end(),
+                                  lists[i].first, lists[i].first + lists[i].second, std::back_inserter(narrowed));
+            candidates.swap(narrowed);
+        }
+        for (uint32_t id : candidates) report(id);
+    }
+
+    template <typename Callback>
+    void forEachEntry(Callback&& onEntry) const {
+        if (!header) return;
+        for (uint32_t id = 0; id < header->entryCount; id++) {
+            const Record& record = records()[id];
+            onEntry(std::string_view(stringAt(record.pathOffset), record.pathLength), record.type == DT_DIR);
+        }
+    }
+
+    static bool build(const fs::path& root, const FileIndex* previous, BuildStats& stats) {
+        ScopedTimer timer("index.build");
+        std::string rootString = root.string();
+        struct stat rootStat;
+        if (stat(rootString.c_str(), &rootStat) != 0) return false;
+
+        std::vector<PendingRecord> pendingRecords;
+        if (previous && previous->isLoaded()) {
+            previous->collectIncremental(rootString, rootStat, pendingRecords, stats);
+        } else {
+            collectFull(rootString, pendingRecords, stats);
+        }
+        std::sort(pendingRecords.begin(), pendingRecords.end(),
+            [](const PendingRecord& a, const PendingRecord& b) { return a.path < b.path; });
+        stats.entries = pendingRecords.size();
+        return write(rootString, mtimeOf(rootStat), pendingRecords);
+    }
+
+private:
+    static constexpr char indexMagic[8] = {'F', 'E', 'I', 'D', 'X', '0', '0', '1'};
+
+    struct Header {
+        char magic[8];
+        uint32_t entryCount;
+        uint32_t trigramCount;
+        uint32_t postingCount;
+        uint32_t rootLength;
+        uint64_t stringBytes;
+        int64_t builtAt;
+        int64_t rootMtime;
+    };
+
+    struct Record {
+        uint64_t pathOffset;
+        uint32_t pathLength;
+        uint32_t nameOffset;
+        uint64_t size;
+        int64_t mtime;
+        uint64_t inode;
+        uint32_t type;
+        uint32_t reserved;
+    };
+
+    struct TrigramSlot {
+        uint32_t trigram;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct PendingRecord {
+        std::string path;
+        uint64_t size;
+        int64_t mtime;
+        uint64_t inode;
+        uint32_t type;
+    };
+
+    const char* base = nullptr;
+    size_t mappedBytes = 0;
+    const Header* header = nullptr;
+
+    const Record* records() const {
+        return reinterpret_cast<const Record*>(base + sizeof(Header));
+    }
+    const TrigramSlot* trigrams() const {
+        return reinterpret_cast<const TrigramSlot*>(records() + header->entryCount);
+    }
+    const uint32_t* postings() const {
+        return reinterpret_cast<const uint32_t*>(trigrams() + header->trigramCount);
+    }
+    const char* stringAt(uint64_t offset) const {
+        return reinterpret_cast<const char*>(postings() + header->postingCount) + offset;
+    }
+
+    bool validLayout() const {
+        uint64_t expected = sizeof(Header);
+        auto grow = [&expected](uint64_t count, uint64_t unit) {
+            uint64_t bytes;
+            return !__builtin_mul_overflow(count, unit, &bytes) && !__builtin_add_overflow(expected, bytes, &expected);
+        };
+        if (!grow(header->entryCount, sizeof(Record)) || !grow(header->trigramCount, sizeof(TrigramSlot)) ||
+            !grow(header->postingCount, sizeof(uint32_t)) || !grow(header->stringBytes, 1) ||
+            expected != mappedBytes || header->rootLength > header->stringBytes) {
+            return false;
+        }
+        for (uint32_t id = 0; id < header->entryCount; id++) {
+            const Record& record = records()[id];
+            if (record.pathOffset > header->stringBytes || record.pathLength > header->stringBytes - record.pathOffset ||
+                record.nameOffset > record.pathLength) {
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < header->trigramCount; i++) {
+            const TrigramSlot& slot = trigrams()[i];
+            if (slot.first > header->postingCount || slot.count > header->postingCount - slot.first) return false;
+        }
+        for (uint32_t i = 0; i < header->postingCount; i++) {
+            if (postings()[i] >= header->entryCount) return false;
+        }
+        return true;
+    }
+
+    static std::string withSlash(std::string path) {
+        if (path.empty() || path.back() != '/') path += '/';
+        return path;
+    }
+
+    static int64_t mtimeOf(const struct stat& st) {
+        return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+
+    static uint32_t trigramKey(const char* p) {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(p[0])) << 16) |
+               (static_cast<uint32_t>(static_cast<unsigned char>(p[1])) << 8) |
+               static_cast<uint32_t>(static_cast<unsigned char>(p[2]));
+    }
+
+    static PendingRecord makeRecord(std::string path, const struct stat& st) {
+        return PendingRecord{std::move(path), static_cast<uint64_t>(st.st_size), mtimeOf(st),
+                             static_cast<uint64_t>(st.st_ino), static_cast<uint32_t>(IFTODT(st.st_mode))};
+    }
+
+    static void collectFull(const std::string& root, std::vector<PendingRecord>& out, BuildStats& stats) {
+        std::mutex lock;
+        size_t prefixLength = withSlash(root).size();
+        ParallelWalker walker;
+        walker.walk(root, [&](const WalkEntry& entry) {
+            struct stat st;
+            if (fstatat(entry.dirFd, entry.name, &st, AT_SYMLINK_NOFOLLOW) != 0) return true;
+            std::lock_guard<std::mutex> guard(lock);
+            out.push_back(makeRecord(entry.path.substr(prefixLength), st));
+            return true;
+        });
+        stats.directoriesRescanned = walker.directoryCount();
+    }
+
+    void collectIncremental(const std::string& root, const struct stat& rootStat,
+                            std::vector<PendingRecord>& out, BuildStats& stats) const {
+        std::unordered_map<std::string_view, uint32_t> byPath;
+        std::unordered_map<std::string_view, std::vector<uint32_t>> childrenByDir;
+        for (uint32_t id = 0; id < header->entryCount; id++) {
+            const Record& record = records()[id];
+            std::string_view path(stringAt(record.pathOffset), record.pathLength);
+            byPath.emplace(path, id);
+            std::string_view parent = record.nameOffset ? path.substr(0, record.nameOffset - 1) : std::string_view();
+            childrenByDir[parent].push_back(id);
+        }
+
+        std::vector<std::pair<std::string, int64_t>> stack{{std::string(), mtimeOf(rootStat)}};
+        while (!stack.empty()) {
+            auto [relative, currentMtime] = std::move(stack.back());
+            stack.pop_back();
+
+            int64_t previousMtime = header->rootMtime;
+            if (!relative.empty()) {
+                auto found = byPath.find(relative);
+                previousMtime = found == byPath.end() ? -1 : records()[found->second].mtime;
+            }
+            std::string absolute = withSlash(root) + relative;
+            std::string prefix = relative.empty() ? std::string() : relative + "/";
+
+            auto children = childrenByDir.find(relative);
+            if (previousMtime == currentMtime && children != childrenByDir.end()) {
+                stats.directoriesReused++;
+                for (uint32_t id : children->second) {
+                    const Record& record = records()[id];
+                    std::string path(stringAt(record.pathOffset), record.pathLength);
+                    if (record.type == DT_DIR) {
+                        struct stat st;
+                        if (lstat((withSlash(root) + path).c_str(), &st) != 0) continue;
+                        out.push_back(makeRecord(path, st));
+                        stack.emplace_back(path, mtimeOf(st));
+                    } else {
+                        out.push_back(PendingRecord{path, record.size, record.mtime, record.inode, record.type});
+                    }
+                }
+                continue;
+            }
+
+            stats.directoriesRescanned++;
+            DIR* dir = opendir(absolute.c_str());
+            if (!dir) continue;
+            while (dirent* entry = readdir(dir)) {
+                const char* name = entry->d_name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+                struct stat st;
+                if (fstatat(dirfd(dir), name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+                out.push_back(makeRecord(prefix + name, st));
+                if (S_ISDIR(st.st_mode)) stack.emplace_back(prefix + name, mtimeOf(st));
+            }
+            closedir(dir);
+        }
+    }
+
+    static bool write(const std::string& root, int64_t rootMtime, const std::vector<PendingRecord>& pendingRecords) {
+        std::vector<Record> outRecords;
+        std::vector<std::pair<uint32_t, uint32_t>> trigramPairs;
+        std::string strings = root;
+        outRecords.reserve(pendingRecords.size());
+
+        for (uint32_t id = 0; id < pendingRecords.size(); id++) {
+            const PendingRecord& pending = pendingRecords[id];
+            size_t slash = pending.path.rfind('/');
+            uint32_t nameOffset = slash == std::string::npos ? 0 : static_cast<uint32_t>(slash + 1);
+            outRecords.push_back(Record{strings.size(), static_cast<uint32_t>(pending.path.size()), nameOffset,
+                                        pending.size, pending.mtime, pending.inode, pending.type, 0});
+            strings += pending.path;
+            for (size_t i = nameOffset; i + 3 <= pending.path.size(); i++) {
+                trigramPairs.emplace_back(trigramKey(pending.path.data() + i), id);
+            }
+        }
+        std::sort(trigramPairs.begin(), trigramPairs.end());
+        trigramPairs.erase(std::unique(trigramPairs.begin(), trigramPairs.end()), trigramPairs.end());
+
+        std::vector<TrigramSlot> slots;
+        std::vector<uint32_t> postingIds;
+        postingIds.reserve(trigramPairs.size());
+        for (const auto& [key, id] : trigramPairs) {
+            if (slots.empty() || slots.back().trigram != key) {
+                slots.push_back(TrigramSlot{key, static_cast<uint32_t>(postingIds.size()), 0});
+            }
+            slots.back().count++;
+            postingIds.push_back(id);
+        }
+
+        Header out{};
+        std::memcpy(out.magic, indexMagic, sizeof(indexMagic));
+        out.entryCount = static_cast<uint32_t>(outRecords.size());
+        out.trigramCount = static_cast<uint32_t>(slots.size());
+        out.postingCount = static_cast<uint32_t>(postingIds.size());
+        out.rootLength = static_cast<uint32_t>(root.size());
+        out.stringBytes = strings.size();
+        out.builtAt = static_cast<int64_t>(time(nullptr));
+        out.rootMtime = rootMtime;
+
+        fs::path location = locationFor(root);
+        std::error_code ec;
+        fs::create_directories(location.parent_path(), ec);
+        fs::path temporary = location;
+        temporary += ".tmp";
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(reinterpret_cast<const char*>(&out), sizeof(out));
+        file.write(reinterpret_cast<const char*>(outRecords.data()), outRecords.size() * sizeof(Record));
+        file.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(TrigramSlot));
+        file.write(reinterpret_cast<const char*>(postingIds.data()), postingIds.size() * sizeof(uint32_t));
+        file.write(strings.data(), strings.size());
+        file.close();
+        if (!file) return false;
+        fs::rename(temporary, location, ec);
+        return !ec;
+    }
+};
+
+struct EntryStat {
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint32_t mode = 0;
+    int64_t ctime = 0;
+
+    bool isDirectory() const { return S_ISDIR(mode); }
+    bool isRegular() const { return S_ISREG(mode); }
+    fs::perms permissions() const { return static_cast<fs::perms>(mode & 07777); }
+    time_t modifiedSeconds() const { return static_cast<time_t>(mtime / 1000000000); }
+    bool sameVersion(const EntryStat& other) const {
+        return device == other.device && inode == other.inode && mtime == other.mtime && ctime == other.ctime;
+    }
+};
+
+inline bool statEntry(int dirFd, const char* name, EntryStat& out) {
+    const unsigned mask = STATX_TYPE | STATX_MODE | STATX_INO | STATX_SIZE | STATX_MTIME | STATX_CTIME;
+    struct statx sx;
+    Instrumentation::add(Counter::Syscalls);
+    if (statx(dirFd, name, AT_STATX_DONT_SYNC, mask, &sx) != 0 &&
+        statx(dirFd, name, AT_STATX_DONT_SYNC | AT_SYMLINK_NOFOLLOW, mask, &sx) != 0) {
+        return false;
+    }
+    out.device = makedev(sx.stx_dev_major, sx.stx_dev_minor);
+    out.inode = sx.stx_ino;
+    out.size = sx.stx_size;
+    out.mtime = static_cast<int64_t>(sx.stx_mtime.tv_sec) * 1000000000 + sx.stx_mtime.tv_nsec;
+    out.mode = sx.stx_mode;
+    out.ctime = static_cast<int64_t>(sx.stx_ctime.tv_sec) * 1000000000 + sx.stx_ctime.tv_nsec;
+    return true;
+}
+
+class EntryTable {
+public:
+    void append(std::string_view name, const EntryStat& st) {
+        nameOffsets.push_back(static_cast<uint32_t>(names.size()));
+        nameLengths.push_back(static_cast<uint32_t>(name.size()));
+        names.append(name);
+        devices.push_back(st.device);
+        inodes.push_back(st.inode);
+        sizes.push_back(st.size);
+        mtimes.push_back(st.mtime);
+        modes.push_back(st.mode);
+        ctimes.push_back(st.ctime);
+    }
+
+    void sortForDisplay() {
+        order.resize(modes.size());
+        for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return displayLess(a, b); });
+    }
+
+    size_t size() const { return order.size(); }
+
+    std::string_view name(size_t position) const { return rawName(order[position]); }
+
+    EntryStat stat(size_t position) const { return rawStat(order[position]); }
+
+    bool find(std::string_view name, EntryStat& out) const {
+        for (bool isDirectory : {true, false}) {
+            auto it = std::lower_bound(order.begin(), order.end(), name, [&](uint32_t index, std::string_view key) {
+                bool indexIsDir = S_ISDIR(modes[index]);
+                if (indexIsDir != isDirectory) return indexIsDir;
+                return rawName(index) < key;
+            });
+            if (it != order.end() && S_ISDIR(modes[*it]) == isDirectory && rawName(*it) == name) {
+                out = rawStat(*it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::string names;
+    std::vector<uint32_t> nameOffsets;
+    std::vector<uint32_t> nameLengths;
+    std::vector<uint64_t> devices;
+    std::vector<uint64_t> inodes;
+    std::vector<uint64_t> sizes;
+    std::vector<int64_t> mtimes;
+    std::vector<uint32_t> modes;
+    std::vector<int64_t> ctimes;
+    std::vector<uint32_t> order;
+
+    std::string_view rawName(uint32_t index) const {
+        return std::string_view(names).substr(nameOffsets[index], nameLengths[index]);
+    }
+
+    EntryStat rawStat(uint32_t index) const {
+        return EntryStat{devices[index], inodes[index], sizes[index], mtimes[index], modes[index], ctimes[index]};
+    }
+
+    bool displayLess(uint32_t a, uint32_t b) const {
+        bool aIsDir = S_ISDIR(modes[a]);
+        bool bIsDir = S_ISDIR(modes[b]);
+        if (aIsDir != bIsDir) return aIsDir;
+        return rawName(a) < rawName(b);
+    }
+};
+
+class MetadataCache {
+public:
+    static constexpr std::chrono::seconds defaultMaxAge{30};
+
+    explicit MetadataCache(size_t capacity = 64, std::chrono::steady_clock::duration maxAge = defaultMaxAge)
+        : capacity(capacity), maxAge(maxAge) {}
+
+    std::shared_ptr<const EntryTable> listDirectory(const fs::path& dir) {
+        EntryStat dirStat;
+        if (!statEntry(AT_FDCWD, dir.c_str(), dirStat)) {
+            throw fs::filesystem_error("cannot stat directory", dir, std::error_code(errno, std::generic_category()));
+        }
+        Key key{dirStat.device, dirStat.inode, dirStat.mtime};
+        if (auto cached = find(key)) return cached;
+
+        int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            throw fs::filesystem_error("cannot open directory", dir, std::error_code(errno, std::generic_category()));
+        }
+        auto table = std::make_shared<EntryTable>();
+        std::vector<char> buffer(64 * 1024);
+        long bytes;
+        {
+            ScopedTimer timer("metadata.enumerate");
+            while ((bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size())) > 0) {
+                Instrumentation::add(Counter::Syscalls);
+                for (long offset = 0; offset < bytes;) {
+                    auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+                    offset += dirent->d_reclen;
+                    const char* name = dirent->d_name;
+                    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+                    EntryStat st;
+                    if (statEntry(fd, name, st)) table->append(name, st);
+                }
+            }
+        }
+        int saved = errno;
+        close(fd);
+        Instrumentation::add(Counter::Syscalls, 2);
+        if (bytes < 0) {
+            throw fs::filesystem_error("cannot read directory", dir, std::error_code(saved, std::generic_category()));
+        }
+        {
+            ScopedTimer timer("metadata.sort");
+            table->sortForDisplay();
+        }
+        Instrumentation::add(Counter::Entries, table->size());
+        insert(key, table);
+        return table;
+    }
+
+    bool lookup(const fs::path& path, EntryStat& out) {
+        if (!statEntry(AT_FDCWD, path.c_str(), out)) return false;
+        fs::path parent = path.parent_path();
+        std::string name = path.filename().string();
+        EntryStat dirStat;
+        EntryStat cachedStat;
+        if (!name.empty() && name != "." && name != ".." && statEntry(AT_FDCWD, parent.c_str(), dirStat)) {
+            if (auto cached = find(Key{dirStat.device, dirStat.inode, dirStat.mtime})) {
+                if (cached->find(name, cachedStat) && !cachedStat.sameVersion(out)) invalidate(parent);
+            }
+        }
+        return true;
+    }
+
+    void invalidate(const fs::path& dir) {
+        EntryStat dirStat;
+        if (!statEntry(AT_FDCWD, dir.c_str(), dirStat)) return;
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto it = lru.begin(); it != lru.end();) {
+            if (it->key.device == dirStat.device && it->key.inode == dirStat.inode) {
+                entries.erase(it->key);
+                it = lru.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    uintmax_t hitCount() const { return hits.load(); }
+    uintmax_t missCount() const { return misses.load(); }
+
+private:
+    struct Key {
+        uint64_t device;
+        uint64_t inode;
+        int64_t mtime;
+        bool operator==(const Key& other) const {
+            return device == other.device && inode == other.inode && mtime == other.mtime;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<uint64_t>{}(key.inode * 0x9e3779b97f4a7c15ULL ^ key.device ^
+                                         static_cast<uint64_t>(key.mtime));
+        }
+    };
+
+    struct Slot {
+        Key key;
+        std::shared_ptr<const EntryTable> table;
+        std::chrono::steady_clock::time_point loaded;
+    };
+
+    using LruList = std::list<Slot>;
+
+    size_t capacity;
+    std::chrono::steady_clock::duration maxAge;
+    std::mutex lock;
+    LruList lru;
+    std::unordered_map<Key, LruList::iterator, KeyHash> entries;
+    std::atomic<uintmax_t> hits{0};
+    std::atomic<uintmax_t> misses{0};
+
+    std::shared_ptr<const EntryTable> find(const Key& key) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = entries.find(key);
+        if (it != entries.end() && std::chrono::steady_clock::now() - it->second->loaded > maxAge) {
+            lru.erase(it->second);
+            entries.erase(it);
+            it = entries.end();
+        }
+        if (it == entries.end()) {
+            misses++;
+            return nullptr;
+        }
+        hits++;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->table;
+    }
+
+    void insert(const Key& key, std::shared_ptr<const EntryTable> table) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            lru.erase(it->second);
+            entries.erase(it);
+        }
+        lru.push_front(Slot{key, std::move(table), std::chrono::steady_clock::now()});
+        entries[key] = lru.begin();
+        while (entries.size() > capacity) {
+            entries.erase(lru.back().key);
+            lru.pop_back();
+        }
+    }
+};
+
+struct ListingEntry {
+    std::string name;
+    EntryStat stat;
+};
+
+class PagedLister {
+public:
+    using Key = std::pair<bool, std::string>;
+
+    PagedLister(fs::path dir, size_t pageSize) : dir(std::move(dir)), pageSize(std::max<size_t>(1, pageSize)) {}
+
+    static bool exceeds(const fs::path& dir, size_t limit) {
+        EntryStat dirStat;
+        if (!statEntry(AT_FDCWD, dir.c_str(), dirStat)) return false;
+        SizeKey sizeKey{dirStat.device, dirStat.inode, dirStat.mtime, limit};
+        {
+            std::lock_guard<std::mutex> guard(sizeLock);
+            auto known = sizeDecisions.find(sizeKey);
+            if (known != sizeDecisions.end()) return known->second;
+        }
+
+        int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return false;
+        std::vector<char> buffer(64 * 1024);
+        size_t count = 0;
+        long bytes;
+        while (count <= limit + 2 && (bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size())) > 0) {
+            for (long offset = 0; offset < bytes; count++) {
+                offset += reinterpret_cast<LinuxDirent64*>(buffer.data() + offset)->d_reclen;
+            }
+        }
+        close(fd);
+        bool large = count > limit + 2;
+        std::lock_guard<std::mutex> guard(sizeLock);
+        if (sizeDecisions.size() >= sizeDecisionCapacity) sizeDecisions.clear();
+        sizeDecisions[sizeKey] = large;
+        return large;
+    }
+
+    bool firstPage() {
+        firstIndex = 0;
+        return scan(nullptr, nullptr, false);
+    }
+
+    bool nextPage() {
+        if (entries.empty() || firstIndex + entries.size() >= total) return false;
+        size_t previousSize = entries.size();
+        Key after = keyOf(entries.back());
+        if (!scan(&after, nullptr, false)) return false;
+        firstIndex += previousSize;
+        return true;
+    }
+
+    bool previousPage() {
+        if (entries.empty() || firstIndex == 0) return false;
+        Key before = keyOf(entries.front());
+        if (!scan(nullptr, &before, true)) return false;
+        firstIndex = firstIndex > entries.size() ? firstIndex - entries.size() : 0;
+        return true;
+    }
+
+    const std::vector<ListingEntry>& page() const { return entries; }
+    size_t pageStart() const { return firstIndex; }
+    size_t totalEntries() const { return total; }
+
+private:
+    using SizeKey = std::tuple<uint64_t, uint64_t, int64_t, size_t>;
+    static constexpr size_t sizeDecisionCapacity = 1024;
+
+    static inline std::mutex sizeLock;
+    static inline std::map<SizeKey, bool> sizeDecisions;
+
+    fs::path dir;
+    size_t pageSize;
+    size_t firstIndex = 0;
+    size_t total = 0;
+    std::vector<ListingEntry> entries;
+
+    static Key keyOf(const ListingEntry& entry) {
+        return Key{!entry.stat.isDirectory(), entry.name};
+    }
+
+    bool scan(const Key* after, const Key* before, bool keepLargest) {
+        ScopedTimer timer("paged.scan");
+        int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            throw fs::filesystem_error("cannot open directory", dir, std::error_code(errno, std::generic_category()));
+        }
+        std::priority_queue<Key> smallest;
+        std::priority_queue<Key, std::vector<Key>, std::greater<Key>> largest;
+        std::vector<char> buffer(64 * 1024);
+        size_t count = 0;
+        long bytes;
+        while ((bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size())) > 0) {
+            Instrumentation::add(Counter::Syscalls);
+            for (long offset = 0; offset < bytes;) {
+                auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+                offset += dirent->d_reclen;
+                const char* name = dirent->d_name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+                count++;
+
+                bool isDirectory = dirent->d_type == DT_DIR;
+                if (dirent->d_type == DT_LNK || dirent->d_type == DT_UNKNOWN) {
+                    EntryStat st;
+                    isDirectory = statEntry(fd, name, st) && st.isDirectory();
+                }
+                Key key{!isDirectory, name};
+                if ((after && !(*after < key)) || (before && !(key < *before))) continue;
+
+                if (keepLargest) {
+                    if (largest.size() < pageSize) {
+                        largest.push(std::move(key));
+                    } else if (largest.top() < key) {
+                        largest.pop();
+                        largest.push(std::move(key));
+                    }
+                } else if (smallest.size() < pageSize) {
+                    smallest.push(std::move(key));
+                } else if (key < smallest.top()) {
+                    smallest.pop();
+                    smallest.push(std::move(key));
+                }
+            }
+        }
+
+        std::vector<Key> keys;
+        keys.reserve(pageSize);
+        for (; !smallest.empty(); smallest.pop()) keys.push_back(smallest.top());
+        for (; !largest.empty(); largest.pop()) keys.push_back(largest.top());
+        std::sort(keys.begin(), keys.end());
+
+        total = count;
+        Instrumentation::add(Counter::Entries, count);
+        if (!keys.empty()) {
+            entries.clear();
+            for (const auto& key : keys) {
+                EntryStat st;
+                if (!statEntry(fd, key.second.c_str(), st)) st.mode = key.first ? S_IFREG : S_IFDIR;
+                entries.push_back(ListingEntry{key.second, st});
+            }
+        }
+        close(fd);
+        return !keys.empty();
+    }
+};
+
+class DirectoryPrefetcher {
+public:
+    explicit DirectoryPrefetcher(MetadataCache& cache, size_t budget = 32, size_t entryLimit = 20000,
+                                 unsigned threadCount = 2)
+        : cache(cache), budget(budget), entryLimit(entryLimit) {
+        for (unsigned i = 0; i < threadCount; i++) workers.emplace_back([this] { workerLoop(); });
+    }
+
+    DirectoryPrefetcher(const DirectoryPrefetcher&) = delete;
+    DirectoryPrefetcher& operator=(const DirectoryPrefetcher&) = delete;
+
+    ~DirectoryPrefetcher() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+            queue.clear();
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    void prefetchAround(const fs::path& dir) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            generation++;
+            queue.clear();
+            remaining = budget;
+            queue.push_back(Task{dir, generation, true});
+            if (dir.has_parent_path() && dir.parent_path() != dir) {
+                queue.push_back(Task{dir.parent_path(), generation, false});
+            }
+        }
+        wake.notify_all();
+    }
+
+    void cancel() {
+        std::lock_guard<std::mutex> guard(lock);
+        generation++;
+        queue.clear();
+    }
+
+    uintmax_t prefetchedCount() const { return prefetched.load(); }
+
+private:
+    struct Task {
+        fs::path dir;
+        uint64_t generation;
+        bool expand;
+    };
+
+    MetadataCache& cache;
+    size_t budget;
+    size_t entryLimit;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::deque<Task> queue;
+    std::vector<std::thread> workers;
+    uint64_t generation = 0;
+    size_t remaining = 0;
+    bool stopping = false;
+    std::atomic<uintmax_t> prefetched{0};
+
+    bool current(uint64_t taskGeneration) {
+        std::lock_guard<std::mutex> guard(lock);
+        return !stopping && taskGeneration == generation;
+    }
+
+    void workerLoop() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [this] { return stopping || !queue.empty(); });
+                if (stopping) return;
+                task = std::move(queue.front());
+                queue.pop_front();
+                if (remaining == 0) continue;
+                remaining--;
+            }
+            if (PagedLister::exceeds(task.dir, entryLimit) || !current(task.generation)) continue;
+
+            std::shared_ptr<const EntryTable> table;
+            try {
+                ScopedTimer timer("prefetch.directory");
+                table = cache.listDirectory(task.dir);
+                prefetched++;
+            } catch (const fs::filesystem_error&) {
+                continue;
+            }
+            if (!task.expand) continue;
+
+            std::lock_guard<std::mutex> guard(lock);
+            if (stopping || task.generation != generation) continue;
+            for (size_t i = 0; i < table->size() && queue.size() < remaining; i++) {
+                if (!table->stat(i).isDirectory()) break;
+                queue.push_back(Task{task.dir / std::string(table->name(i)), task.generation, false});
+            }
+            wake.notify_all();
+        }
+    }
+};
+
+class DirectoryWatcher {
+public:
+    DirectoryWatcher() = default;
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+    ~DirectoryWatcher() { stop(); }
+
+    bool watchListing(const fs::path& dir, MetadataCache* cache = nullptr) {
+        if (!start()) return false;
+        std::lock_guard<std::mutex> guard(lock);
+        if (listingValid && listingDir == dir) return true;
+
+        if (listingWd >= 0 && !subtreeDirs.count(listingWd)) {
+            inotify_rm_watch(inotifyFd, listingWd);
+        }
+        listingWd = inotify_add_watch(inotifyFd, dir.c_str(), watchMask);
+        listingDir = dir;
+        listingCache = cache;
+        listing.clear();
+        if (listingWd < 0) {
+            listingValid = false;
+            if (errno == ENOSPC) watchLimitReached = true;
+            return false;
+        }
+
+        std::shared_ptr<const EntryTable> snapshot;
+        if (cache) {
+            try {
+                snapshot = cache->listDirectory(dir);
+            } catch (const fs::filesystem_error&) {
+            }
+        }
+        if (snapshot) {
+            for (size_t i = 0; i < snapshot->size(); i++) {
+                std::string name(snapshot->name(i));
+                EntryStat st = snapshot->stat(i);
+                listing[{!st.isDirectory(), name}] = ListingEntry{name, st};
+            }
+            listingValid = true;
+            return true;
+        }
+
+        std::error_code ec;
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            applyChange(it->path().filename().string());
+        }
+        listingValid = !ec;
+        return listingValid;
+    }
+
+    void watchSubtree(const fs::path& root) {
+        if (!start()) return;
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto& [wd, path] : subtreeDirs) {
+            if (wd != listingWd) inotify_rm_watch(inotifyFd, wd);
+        }
+        subtreeDirs.clear();
+        subtreeRoot = root;
+        watchLimitReached = false;
+        addSubtreeWatches(root);
+    }
+
+    template <typename Callback>
+    void forEachListed(Callback&& callback) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto& [key, entry] : listing) {
+            callback(entry);
+        }
+    }
+
+    uintmax_t eventsApplied() const { return events.load(); }
+    uintmax_t overflowCount() const { return overflows.load(); }
+    uintmax_t indexRefreshCount() const { return indexRefreshes.load(); }
+    bool subtreeWatchLimited() {
+        std::lock_guard<std::mutex> guard(lock);
+        return watchLimitReached;
+    }
+    size_t subtreeWatchCount() {
+        std::lock_guard<std::mutex> guard(lock);
+        return subtreeDirs.size();
+    }
+    bool keepsIndexCurrent(const fs::path& root) {
+        std::lock_guard<std::mutex> guard(lock);
+        return subtreeRoot == root && !watchLimitReached;
+    }
+    bool indexPending() {
+        std::lock_guard<std::mutex> guard(lock);
+        return indexDirty || refreshing;
+    }
+
+    void stop() {
+        if (!running) return;
+        running = false;
+        if (worker.joinable()) worker.join();
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+
+private:
+    static constexpr uint32_t watchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB |
+                                          IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+    static constexpr auto indexSettleTime = std::chrono::seconds(2);
+    static constexpr auto limitedRefreshInterval = std::chrono::seconds(60);
+
+    std::mutex lock;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    int inotifyFd = -1;
+
+    fs::path listingDir;
+    int listingWd = -1;
+    bool listingValid = false;
+    MetadataCache* listingCache = nullptr;
+    std::map<std::pair<bool, std::string>, ListingEntry> listing;
+
+    fs::path subtreeRoot;
+    std::unordered_map<int, fs::path> subtreeDirs;
+    bool watchLimitReached = false;
+    bool indexDirty = false;
+    bool refreshing = false;
+    std::chrono::steady_clock::time_point lastSubtreeChange;
+
+    std::atomic<uintmax_t> events{0};
+    std::atomic<uintmax_t> overflows{0};
+    std::atomic<uintmax_t> indexRefreshes{0};
+
+    bool start() {
+        if (running) return true;
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd < 0) return false;
+        running = true;
+        worker = std::thread([this] { eventLoop(); });
+        return true;
+    }
+
+    void applyChange(const std::string& name) {
+        listing.erase({false, name});
+        listing.erase({true, name});
+        EntryStat st;
+        if (!statEntry(AT_FDCWD, (listingDir / name).c_str(), st)) return;
+        listing[{!st.isDirectory(), name}] = ListingEntry{name, st};
+    }
+
+    void addSubtreeWatches(const fs::path& root) {
+        std::vector<fs::path> stack{root};
+        while (!stack.empty() && !watchLimitReached) {
+            fs::path dir = std::move(stack.back());
+            stack.pop_back();
+            int wd = inotify_add_watch(inotifyFd, dir.c_str(), watchMask);
+            if (wd < 0) {
+                if (errno == ENOSPC) watchLimitReached = true;
+                continue;
+            }
+            subtreeDirs[wd] = dir;
+            std::error_code ec;
+            for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+                if (it->is_directory(ec) && !it->is_symlink(ec)) stack.push_back(it->path());
+            }
+        }
+    }
+
+    void handleEvent(const inotify_event* event) {
+        events++;
+        if (event->mask & IN_Q_OVERFLOW) {
+            overflows++;
+            listingValid = false;
+            markSubtreeDirty();
+            return;
+        }
+        if (event->wd == listingWd) {
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                listingValid = false;
+            } else if (event->len > 0) {
+                applyChange(event->name);
+            }
+            if (listingCache) listingCache->invalidate(listingDir);
+        }
+        auto subtree = subtreeDirs.find(event->wd);
+        if (subtree != subtreeDirs.end()) {
+            markSubtreeDirty();
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)) && event->len > 0) {
+                addSubtreeWatches(subtree->second / event->name);
+            }
+            if (event->mask & IN_IGNORED) subtreeDirs.erase(subtree);
+        }
+        if ((event->mask & IN_IGNORED) && event->wd == listingWd) listingWd = -1;
+    }
+
+    void markSubtreeDirty() {
+        if (subtreeRoot.empty()) return;
+        indexDirty = true;
+        lastSubtreeChange = std::chrono::steady_clock::now();
+    }
+
+    void refreshIndexIfSettled() {
+        fs::path root;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto now = std::chrono::steady_clock::now();
+            if (subtreeRoot.empty()) return;
+            if (watchLimitReached && now - lastSubtreeChange > limitedRefreshInterval) indexDirty = true;
+            if (!indexDirty || now - lastSubtreeChange < indexSettleTime) return;
+            indexDirty = false;
+            refreshing = true;
+            if (watchLimitReached) lastSubtreeChange = now;
+            root = subtreeRoot;
+        }
+        FileIndex previous;
+        if (previous.load(root)) {
+            FileIndex::BuildStats stats;
+            if (FileIndex::build(root, &previous, stats)) indexRefreshes++;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        refreshing = false;
+    }
+
+    void eventLoop() {
+        alignas(inotify_event) char buffer[64 * 1024];
+        while (running) {
+            pollfd descriptor{inotifyFd, POLLIN, 0};
+            int ready = poll(&descriptor, 1, 250);
+            if (ready > 0) {
+                ssize_t bytes;
+                while ((bytes = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    for (ssize_t offset = 0; offset < bytes;) {
+                        auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                        handleEvent(event);
+                        offset += sizeof(inotify_event) + event->len;
+                    }
+                }
+            }
+            refreshIndexIfSettled();
+        }
+    }
+};
+
+enum class CopyMethod { Reflink, CopyFileRange, Sendfile, ReadWrite };
+
+struct CopyResult {
+    CopyMethod method = CopyMethod::Reflink;
+    uintmax_t bytes = 0;
+    double seconds = 0;
+    bool sparse = false;
+
+    double throughputMBps() const {
+        return seconds > 0 ? bytes / seconds / (1024.0 * 1024.0) : 0;
+    }
+};
+
+class CopyEngine {
+public:
+    using Progress = std::function<void(uintmax_t copied, uintmax_t total)>;
+
+    static const char* methodName(CopyMethod method) {
+        switch (method) {
+            case CopyMethod::Reflink: return "reflink";
+            case CopyMethod::CopyFileRange: return "copy_file_range";
+            case CopyMethod::Sendfile: return "sendfile";
+            case CopyMethod::ReadWrite: return "read/write";
+        }
+        return "unknown";
+    }
+
+    static CopyResult copyFile(const fs::path& from, const fs::path& to,
+                               CopyMethod firstMethod = CopyMethod::Reflink, bool allowFallback = true,
+                               const Progress& progress = nullptr) {
+        ScopedTimer timer("copy.file");
+        auto start = std::chrono::steady_clock::now();
+        int source = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+        if (source < 0) fail("cannot open source", from, to);
+        struct stat st;
+        if (fstat(source, &st) != 0) {
+            int saved = errno;
+            close(source);
+            errno = saved;
+            fail("cannot stat source", from, to);
+        }
+        struct stat existing;
+        if (stat(to.c_str(), &existing) == 0 && existing.st_dev == st.st_dev && existing.st_ino == st.st_ino) {
+            close(source);
+            errno = EEXIST;
+            fail("source and destination are the same file", from, to);
+        }
+        int dest = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 07777);
+        if (dest < 0) {
+            int saved = errno;
+            close(source);
+            errno = saved;
+            fail("cannot open destination", from, to);
+        }
+
+        CopyResult result;
+        result.method = firstMethod;
+        bool ok = copyDescriptors(source, dest, st, result, allowFallback, progress);
+        int saved = errno;
+        if (ok && fchmod(dest, st.st_mode & 07777) != 0) {
+            ok = false;
+            saved = errno;
+        }
+        close(source);
+        if (close(dest) != 0 && ok) {
+            ok = false;
+            saved = errno;
+        }
+        Instrumentation::add(Counter::Syscalls, 7);
+        if (!ok) {
+            errno = saved;
+            fail("copy failed", from, to);
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        Instrumentation::add(Counter::Bytes, result.bytes);
+        return result;
+    }
+
+    static CopyResult copyFileAtomic(const fs::path& from, const fs::path& to, unsigned renameFlags = 0,
+                                     const Progress& progress = nullptr) {
+        struct stat source, existing;
+        if (stat(from.c_str(), &source) != 0) fail("cannot stat source", from, to);
+        if (stat(to.c_str(), &existing) == 0 && existing.st_dev == source.st_dev && existing.st_ino == source.st_ino) {
+            errno = EEXIST;
+            fail("source and destination are the same file", from, to);
+        }
+        fs::path temp = to.parent_path() / ("." + to.filename().string() + ".fxpart");
+        CopyResult result;
+        try {
+            result = copyFile(from, temp, CopyMethod::Reflink, true, progress);
+        } catch (const fs::filesystem_error&) {
+            unlink(temp.c_str());
+            throw;
+        }
+        const timespec times[2] = {source.st_atim, source.st_mtim};
+        utimensat(AT_FDCWD, temp.c_str(), times, 0);
+        Instrumentation::add(Counter::Syscalls, 4);
+        int renamed = renameat2(AT_FDCWD, temp.c_str(), AT_FDCWD, to.c_str(), renameFlags);
+        if (renamed != 0 && errno == EINVAL && renameFlags != 0) renamed = rename(temp.c_str(), to.c_str());
+        if (renamed != 0) {
+            int saved = errno;
+            unlink(temp.c_str());
+            errno = saved;
+            fail("cannot move copy into place", temp, to);
+        }
+        return result;
+    }
+
+private:
+    static constexpr size_t chunkSize = 8 * 1024 * 1024;
+    static constexpr size_t bufferSize = 1024 * 1024;
+
+    [[noreturn]] static void fail(const char* what, const fs::path& from, const fs::path& to) {
+        throw fs::filesystem_error(what, from, to, std::error_code(errno, std::generic_category()));
+    }
+
+    static bool unsupported(int error) {
+        return error == EXDEV || error == ENOSYS || error == EOPNOTSUPP || error == EINVAL ||
+               error == ENOTTY || error == EBADF || error == EPERM;
+    }
+
+    static bool copyDescriptors(int source, int dest, const struct stat& st, CopyResult& result,
+                                bool allowFallback, const Progress& progress) {
+        uintmax_t total = static_cast<uintmax_t>(st.st_size);
+        if (result.method == CopyMethod::Reflink) {
+            Instrumentation::add(Counter::Syscalls);
+            if (ioctl(dest, FICLONE, source) == 0) {
+                result.bytes = total;
+                if (progress) progress(total, total);
+                return true;
+            }
+            if (!allowFallback || !unsupported(errno)) return false;
+            result.method = CopyMethod::CopyFileRange;
+        }
+
+        posix_fadvise(source, 0, 0, POSIX_FADV_SEQUENTIAL);
+        Instrumentation::add(Counter::Syscalls, 2);
+        result.sparse = static_cast<uintmax_t>(st.st_blocks) * 512 < total;
+        if (ftruncate(dest, st.st_size) != 0) return false;
+
+        std::vector<char> buffer;
+        off_t dataStart = 0;
+        while (dataStart < st.st_size) {
+            off_t dataEnd = st.st_size;
+            if (result.sparse) {
+                Instrumentation::add(Counter::Syscalls, 2);
+                dataStart = lseek(source, dataStart, SEEK_DATA);
+                if (dataStart < 0) {
+                    if (errno == ENXIO) break;
+                    result.sparse = false;
+                    dataStart = 0;
+                } else {
+                    dataEnd = lseek(source, dataStart, SEEK_HOLE);
+                    if (dataEnd < 0) dataEnd = st.st_size;
+                }
+            }
+
+            off_t offset = dataStart;
+            while (offset < dataEnd) {
+                size_t length = static_cast<size_t>(std::min<off_t>(dataEnd - offset, chunkSize));
+                ssize_t copied = copyChunk(source, dest, offset, length, result.method, buffer);
+                if (copied < 0) {
+                    if (!allowFallback || result.method == CopyMethod::ReadWrite || !unsupported(errno)) return false;
+                    result.method = result.method == CopyMethod::CopyFileRange ? CopyMethod::Sendfile
+                                                                               : CopyMethod::ReadWrite;
+                    continue;
+                }
+                if (copied == 0) break;
+                offset += copied;
+                result.bytes += copied;
+                if (progress) progress(result.bytes, total);
+            }
+            dataStart = dataEnd;
+        }
+        return true;
+    }
+
+    static ssize_t copyChunk(int source, int dest, off_t offset, size_t length, CopyMethod method,
+                             std::vector<char>& buffer) {
+        switch (method) {
+            case CopyMethod::CopyFileRange: {
+                Instrumentation::add(Counter::Syscalls);
+                loff_t in = offset;
+                loff_t out = offset;
+                return copy_file_range(source, &in, dest, &out, length, 0);
+            }
+            case CopyMethod::Sendfile: {
+                Instrumentation::add(Counter::Syscalls, 2);
+                if (lseek(dest, offset, SEEK_SET) < 0) return -1;
+                off_t in = offset;
+                return sendfile(dest, source, &in, length);
+            }
+            default: {
+                if (buffer.empty()) buffer.resize(bufferSize);
+                ssize_t bytes = pread(source, buffer.data(), std::min(length, buffer.size()), offset);
+                Instrumentation::add(Counter::Syscalls);
+                if (bytes <= 0) return bytes;
+                for (ssize_t written = 0; written < bytes;) {
+                    ssize_t n = pwrite(dest, buffer.data() + written, bytes - written, offset + written);
+                    Instrumentation::add(Counter::Syscalls);
+                    if (n < 0) return -1;
+                    written += n;
+                }
+                posix_fadvise(source, offset, bytes, POSIX_FADV_DONTNEED);
+                Instrumentation::add(Counter::Syscalls);
+                return bytes;
+            }
+        }
+    }
+};
+
+class TaskPool {
+public:
+    TaskPool(unsigned threadCount, size_t capacity) : capacity(std::max<size_t>(1, capacity)) {
+        for (unsigned i = 0; i < std::max(1u, threadCount); i++) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    ~TaskPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(std::function<void()> task) {
+        std::unique_lock<std::mutex> guard(lock);
+        spaceAvailable.wait(guard, [this] { return tasks.size() < capacity; });
+        tasks.push_back(std::move(task));
+        active++;
+        guard.unlock();
+        taskReady.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        allDone.wait(guard, [this] { return active == 0; });
+    }
+
+private:
+    size_t capacity;
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable taskReady;
+    std::condition_variable spaceAvailable;
+    std::condition_variable allDone;
+    size_t active = 0;
+    bool stopping = false;
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                taskReady.wait(guard, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            spaceAvailable.notify_one();
+            task();
+            std::lock_guard<std::mutex> guard(lock);
+            if (--active == 0) allDone.notify_all();
+        }
+    }
+};
+
+class JobInterrupt {
+public:
+    JobInterrupt() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (depth++ > 0) return;
+        flag = false;
+        struct sigaction action {};
+        action.sa_handler = [](int) { flag = true; };
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGINT, &action, &previous);
+    }
+
+    JobInterrupt(const JobInterrupt&) = delete;
+    JobInterrupt& operator=(const JobInterrupt&) = delete;
+
+    ~JobInterrupt() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (--depth == 0) sigaction(SIGINT, &previous, nullptr);
+    }
+
+    static bool requested() { return flag; }
+
+private:
+    static inline std::atomic<bool> flag{false};
+    static inline std::mutex lock;
+    static inline size_t depth = 0;
+    static inline struct sigaction previous {};
+};
+
+enum class JobKind { Copy, Move, Delete };
+
+class JobJournal {
+public:
+    static constexpr size_t syncBatch = 512;
+    static constexpr std::chrono::milliseconds syncInterval{500};
+
+    struct Info {
+        std::string id;
+        JobKind kind;
+        std::string source;
+        std::string target;
+        size_t completed = 0;
+    };
+
+    static const char* kindName(JobKind kind) {
+        switch (kind) {
+            case JobKind::Copy: return "copy";
+            case JobKind::Move: return "move";
+            case JobKind::Delete: return "delete";
+        }
+        return "unknown";
+    }
+
+    static fs::path directory() {
+        const char* cacheHome = getenv("XDG_CACHE_HOME");
+        const char* home = getenv("HOME");
+        fs::path base = cacheHome ? fs::path(cacheHome) : fs::path(home ? home : "/tmp") / ".cache";
+        return base / "file_explorer" / "jobs";
+    }
+
+    static std::vector<Info> pending() {
+        std::vector<Info> jobs;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(directory(), ec)) {
+            if (entry.path().extension() != ".journal") continue;
+            Info info;
+            std::set<std::string> units;
+            std::set<std::string> phases;
+            if (!parse(entry.path(), info, units, phases)) continue;
+            info.id = entry.path().stem().string();
+            info.completed = units.size();
+            jobs.push_back(info);
+        }
+        std::sort(jobs.begin(), jobs.end(), [](const Info& a, const Info& b) { return a.id < b.id; });
+        return jobs;
+    }
+
+    static void discard(const std::string& id) {
+        std::error_code ec;
+        fs::remove(directory() / (id + ".journal"), ec);
+    }
+
+    JobJournal(JobKind kind, const fs::path& source, const fs::path& target) {
+        std::error_code ec;
+        std::string from = fs::weakly_canonical(fs::absolute(source), ec).string();
+        std::string to = target.empty() ? "" : fs::weakly_canonical(fs::absolute(target), ec).string();
+        fs::create_directories(directory(), ec);
+        char name[48];
+        snprintf(name, sizeof(name), "%016zx.journal",
+                 std::hash<std::string>{}(std::string(kindName(kind)) + '\0' + from + '\0' + to));
+        file = directory() / name;
+
+        Info info;
+        resuming = parse(file, info, completedUnits, phases);
+        fd = open(file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (resuming ? 0 : O_TRUNC), 0600);
+        if (fd < 0) {
+            throw fs::filesystem_error("cannot open job journal", file, std::error_code(errno, std::generic_category()));
+        }
+        if (!resuming) {
+            buffer = "FXJOB1\t" + std::string(kindName(kind)) + "\t" + escape(from) + "\t" + escape(to) + "\n";
+            flushLocked();
+        }
+        syncFd = open((to.empty() ? fs::path(from).parent_path() : fs::path(to).parent_path()).c_str(),
+                      O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+
+    JobJournal(const JobJournal&) = delete;
+    JobJournal& operator=(const JobJournal&) = delete;
+
+    ~JobJournal() {
+        if (fd >= 0) {
+            flush();
+            close(fd);
+        }
+        if (syncFd >= 0) close(syncFd);
+    }
+
+    bool resumed() const { return resuming; }
+    size_t completedCount() const { return completedUnits.size(); }
+    bool done(const std::string& unit) const { return completedUnits.count(unit) != 0; }
+    bool reachedPhase(const std::string& phase) const { return phases.count(phase) != 0; }
+
+    void record(const std::string& unit) {
+        std::lock_guard<std::mutex> guard(lock);
+        buffer += "U\t" + escape(unit) + "\n";
+        if (++unsynced >= syncBatch || std::chrono::steady_clock::now() - lastSync >= syncInterval) flushLocked();
+    }
+
+    void markPhase(const std::string& phase) {
+        std::lock_guard<std::mutex> guard(lock);
+        buffer += "P\t" + escape(phase) + "\n";
+        phases.insert(phase);
+        unsynced++;
+        flushLocked();
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!buffer.empty()) flushLocked();
+    }
+
+    void complete() {
+        std::lock_guard<std::mutex> guard(lock);
+        buffer.clear();
+        close(fd);
+        fd = -1;
+        unlink(file.c_str());
+    }
+
+private:
+    fs::path file;
+    int fd = -1;
+    int syncFd = -1;
+    bool resuming = false;
+    std::set<std::string> completedUnits;
+    std::set<std::string> phases;
+    std::mutex lock;
+    std::string buffer;
+    size_t unsynced = 0;
+    std::chrono::steady_clock::time_point lastSync = std::chrono::steady_clock::now();
+
+    void flushLocked() {
+        ScopedTimer timer("journal.sync");
+        if (unsynced > 0 && syncFd >= 0) syncfs(syncFd);
+        std::string_view data = buffer;
+        while (!data.empty()) {
+            ssize_t written = ::write(fd, data.data(), data.size());
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            data.remove_prefix(static_cast<size_t>(written));
+        }
+        fdatasync(fd);
+        Instrumentation::add(Counter::Syscalls, 3);
+        buffer.clear();
+        unsynced = 0;
+        lastSync = std::chrono::steady_clock::now();
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string out;
+        out.reserve(text.size());
+        for (char c : text) {
+            if (c == '\\') out += "\\\\";
+            else if (c == '\n') out += "\\n";
+            else if (c == '\t') out += "\\t";
+            else out += c;
+        }
+        return out;
+    }
+
+    static std::string unescape(std::string_view text) {
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] != '\\' || i + 1 == text.size()) {
+                out += text[i];
+                continue;
+            }
+            char next = text[++i];
+            out += next == 'n' ? '\n' : next == 't' ? '\t' : next;
+        }
+        return out;
+    }
+
+    static bool parse(const fs::path& path, Info& info, std::set<std::string>& units, std::set<std::string>& phases) {
+        std::ifstream in(path, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        size_t end = content.rfind('\n');
+        if (end == std::string::npos) return false;
+        std::string_view text(content.data(), end + 1);
+        bool header = true;
+        while (!text.empty()) {
+            size_t newline = text.find('\n');
+            std::string_view line = text.substr(0, newline);
+            text.remove_prefix(newline + 1);
+            std::vector<std::string_view> fields;
+            for (size_t tab; (tab = line.find('\t')) != std::string_view::npos; line.remove_prefix(tab + 1)) {
+                fields.push_back(line.substr(0, tab));
+            }
+            fields.push_back(line);
+            if (header) {
+                if (fields.size() != 4 || fields[0] != "FXJOB1") return false;
+                info.kind = fields[1] == "move" ? JobKind::Move : fields[1] == "delete" ? JobKind::Delete : JobKind::Copy;
+                info.source = unescape(fields[2]);
+                info.target = unescape(fields[3]);
+                header = false;
+            } else if (fields.size() == 2 && fields[0] == "U") {
+                units.insert(unescape(fields[1]));
+            } else if (fields.size() == 2 && fields[0] == "P") {
+                phases.insert(unescape(fields[1]));
+            }
+        }
+        return !header;
+    }
+};
+
+struct TreeCopyStats {
+    std::atomic<uintmax_t> files{0};
+    std::atomic<uintmax_t> directories{0};
+    std::atomic<uintmax_t> symlinks{0};
+    std::atomic<uintmax_t> bytes{0};
+    std::atomic<uintmax_t> resumed{0};
+    std::vector<std::string> errors;
+    double seconds = 0;
+    bool crossDevice = false;
+    bool interrupted = false;
+};
+
+class TreeCopier {
+public:
+    static constexpr uintmax_t largeFileThreshold = 1024 * 1024;
+
+    static void copyTree(const fs::path& from, const fs::path& to, TreeCopyStats& stats,
+                         JobJournal* journal = nullptr) {
+        ScopedTimer timer("copy.tree");
+        auto start = std::chrono::steady_clock::now();
+        struct stat rootStat;
+        if (lstat(from.c_str(), &rootStat) != 0) {
+            throw fs::filesystem_error("cannot stat source", from, std::error_code(errno, std::generic_category()));
+        }
+        std::error_code ec;
+        fs::path absoluteFrom = fs::weakly_canonical(from, ec);
+        fs::path absoluteTo = fs::weakly_canonical(to, ec);
+        auto mismatch = std::mismatch(absoluteFrom.begin(), absoluteFrom.end(), absoluteTo.begin(), absoluteTo.end());
+        if (mismatch.first == absoluteFrom.end()) {
+            throw fs::filesystem_error("cannot copy a directory into itself", from, to,
+                                       std::make_error_code(std::errc::invalid_argument));
+        }
+        bool resuming = journal && journal->resumed();
+        Instrumentation::add(Counter::Syscalls, 2);
+        if (mkdir(to.c_str(), S_IRWXU) != 0 && !(resuming && errno == EEXIST)) {
+            throw fs::filesystem_error("cannot create directory", to, std::error_code(errno, std::generic_category()));
+        }
+        stats.directories++;
+        unsigned renameFlags = resuming ? 0 : RENAME_NOREPLACE;
+
+        std::mutex lock;
+        std::vector<std::pair<std::string, struct stat>> createdDirs{{to.string(), rootStat}};
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        TaskPool smallFiles(std::max(4u, cores * 2), cores * 64);
+        TaskPool largeFiles(std::max(2u, cores / 2), cores * 2);
+        std::string fromPrefix = from.string();
+        if (fromPrefix.back() != '/') fromPrefix += '/';
+        std::string toPrefix = to.string();
+        if (toPrefix.back() != '/') toPrefix += '/';
+
+        auto recordError = [&](const std::string& path, int error) {
+            std::lock_guard<std::mutex> guard(lock);
+            stats.errors.push_back(path + ": " + std::strerror(error));
+        };
+
+        ParallelWalker walker;
+        walker.walk(from, [&](const WalkEntry& entry) {
+            if (JobInterrupt::requested()) return false;
+            std::string unit = entry.path.substr(fromPrefix.size());
+            std::string target = toPrefix + unit;
+            if (journal && journal->done(unit)) {
+                stats.resumed++;
+                return false;
+            }
+            struct stat st;
+            Instrumentation::add(Counter::Syscalls);
+            if (fstatat(entry.dirFd, entry.name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                recordError(entry.path, errno);
+                return false;
+            }
+            if (S_ISDIR(st.st_mode)) {
+                Instrumentation::add(Counter::Syscalls);
+                if (mkdir(target.c_str(), S_IRWXU) != 0 && !(resuming && errno == EEXIST)) {
+                    recordError(target, errno);
+                    return false;
+                }
+                stats.directories++;
+                std::lock_guard<std::mutex> guard(lock);
+                createdDirs.emplace_back(target, st);
+                return true;
+            }
+            if (S_ISLNK(st.st_mode)) {
+                Instrumentation::add(Counter::Syscalls, 3);
+                std::vector<char> link(st.st_size > 0 ? st.st_size + 1 : PATH_MAX);
+                ssize_t length = readlinkat(entry.dirFd, entry.name, link.data(), link.size() - 1);
+                if (length >= 0 && resuming) unlink(target.c_str());
+                if (length < 0 || symlink(std::string(link.data(), length).c_str(), target.c_str()) != 0) {
+                    recordError(target, errno);
+                    return false;
+                }
+                if (journal) journal->record(unit);
+                const timespec times[2] = {st.st_atim, st.st_mtim};
+                utimensat(AT_FDCWD, target.c_str(), times, AT_SYMLINK_NOFOLLOW);
+                stats.symlinks++;
+                return false;
+            }
+            if (!S_ISREG(st.st_mode)) {
+                recordError(entry.path, ENOTSUP);
+                return false;
+            }
+            auto copyOne = [&, source = entry.path, target, unit, st] {
+                if (JobInterrupt::requested()) return;
+                try {
+                    CopyResult result = CopyEngine::copyFileAtomic(source, target, renameFlags);
+                    if (journal) journal->record(unit);
+                    stats.files++;
+                    stats.bytes += result.bytes;
+                } catch (const fs::filesystem_error& e) {
+                    recordError(source, e.code().value());
+                }
+            };
+            if (static_cast<uintmax_t>(st.st_size) >= largeFileThreshold) {
+                largeFiles.submit(copyOne);
+            } else {
+                smallFiles.submit(copyOne);
+            }
+            return false;
+        });
+        smallFiles.wait();
+        largeFiles.wait();
+        stats.interrupted = JobInterrupt::requested();
+
+        for (auto it = createdDirs.rbegin(); it != createdDirs.rend() && !stats.interrupted; ++it) {
+            const struct stat& st = it->second;
+            const timespec times[2] = {st.st_atim, st.st_mtim};
+            Instrumentation::add(Counter::Syscalls, 2);
+            if (chmod(it->first.c_str(), st.st_mode & 07777) != 0 ||
+                utimensat(AT_FDCWD, it->first.c_str(), times, 0) != 0) {
+                recordError(it->first, errno);
+            }
+        }
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static void moveTree(const fs::path& from, const fs::path& to, TreeCopyStats& stats,
+                         JobJournal* journal = nullptr);
+};
+
+#if __has_include(<linux/io_uring.h>)
+#define FILE_EXPLORER_HAVE_IO_URING 1
+class UnlinkRing {
+public:
+    UnlinkRing() = default;
+    UnlinkRing(const UnlinkRing&) = delete;
+    UnlinkRing& operator=(const UnlinkRing&) = delete;
+
+    ~UnlinkRing() {
+        if (sqes) munmap(sqes, sqeBytes);
+        if (cqRing && cqRing != sqRing) munmap(cqRing, cqBytes);
+        if (sqRing) munmap(sqRing, sqBytes);
+        if (ringFd >= 0) close(ringFd);
+    }
+
+    bool init(unsigned entries) {
+        io_uring_params params{};
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0) return false;
+
+        sqBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap) sqBytes = cqBytes = std::max(sqBytes, cqBytes);
+
+        sqRing = mmap(nullptr, sqBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            sqRing = nullptr;
+            return false;
+        }
+        cqRing = singleMap ? sqRing
+                           : mmap(nullptr, cqBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                                  IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            return false;
+        }
+        sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMap = mmap(nullptr, sqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                            IORING_OFF_SQES);
+        if (sqeMap == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(sqeMap);
+
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        capacity = params.sq_entries;
+        return true;
+    }
+
+    bool unlinkBatch(int dirFd, const std::vector<std::string>& names, std::vector<int>& results) {
+        results.assign(names.size(), 0);
+        for (size_t first = 0; first < names.size(); first += capacity) {
+            unsigned count = static_cast<unsigned>(std::min<size_t>(capacity, names.size() - first));
+            unsigned tail = *sqTail;
+            for (unsigned i = 0; i < count; i++) {
+                unsigned slot = tail & sqMask;
+                io_uring_sqe* sqe = &sqes[slot];
+                std::memset(sqe, 0, sizeof(*sqe));
+                sqe->opcode = IORING_OP_UNLINKAT;
+                sqe->fd = dirFd;
+                sqe->addr = reinterpret_cast<uint64_t>(names[first + i].c_str());
+                sqe->user_data = first + i;
+                sqArray[slot] = slot;
+                tail++;
+            }
+            __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+            unsigned submitted = 0;
+            unsigned reaped = 0;
+            while (reaped < count) {
+                unsigned toSubmit = count - submitted;
+                long entered = syscall(__NR_io_uring_enter, ringFd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                Instrumentation::add(Counter::Syscalls);
+                if (entered < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                submitted += static_cast<unsigned>(entered);
+                unsigned head = *cqHead;
+                while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+                    const io_uring_cqe& cqe = cqes[head & cqMask];
+                    results[cqe.user_data] = cqe.res;
+                    head++;
+                    reaped++;
+                }
+                __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            }
+        }
+        return true;
+    }
+
+private:
+    int ringFd = -1;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    size_t sqBytes = 0;
+    size_t cqBytes = 0;
+    size_t sqeBytes = 0;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned cqMask = 0;
+    unsigned capacity = 0;
+};
+#endif
+
+struct DeleteStats {
+    std::atomic<uintmax_t> entries{0};
+    std::vector<std::string> failures;
+    bool usedIoUring = false;
+    bool interrupted = false;
+    double seconds = 0;
+};
+
+class TreeDeleter {
+public:
+    using Progress = std::function<void(uintmax_t entries, double seconds)>;
+
+    static void removeTree(const fs::path& root, DeleteStats& stats, const Progress& progress = nullptr) {
+        ScopedTimer timer("delete.tree");
+        auto start = std::chrono::steady_clock::now();
+        TreeDeleter deleter(stats);
+        std::mutex reporterLock;
+        std::condition_variable reporterWake;
+        bool finished = false;
+        std::thread reporter;
+        if (progress) {
+            reporter = std::thread([&] {
+                std::unique_lock<std::mutex> guard(reporterLock);
+                while (!reporterWake.wait_for(guard, std::chrono::milliseconds(250), [&] { return finished; })) {
+                    progress(stats.entries.load(), std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start).count());
+                }
+            });
+        }
+
+        {
+            unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+            TaskPool pool(std::max(4u, cores * 2), std::numeric_limits<size_t>::max());
+            deleter.pool = &pool;
+            auto rootNode = std::make_shared<DirNode>(root.string(), nullptr);
+            pool.submit([&deleter, rootNode] { deleter.processDirectory(rootNode); });
+            pool.wait();
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(reporterLock);
+            finished = true;
+        }
+        reporterWake.notify_all();
+        if (reporter.joinable()) reporter.join();
+        stats.usedIoUring = deleter.ringUsed.load();
+        stats.interrupted = JobInterrupt::requested();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    struct DirNode {
+        std::string path;
+        std::shared_ptr<DirNode> parent;
+        std::atomic<int> pending{1};
+        std::atomic<bool> failed{false};
+        DirNode(std::string path, std::shared_ptr<DirNode> parent) : path(std::move(path)), parent(std::move(parent)) {}
+    };
+
+    DeleteStats& stats;
+    TaskPool* pool = nullptr;
+    std::mutex failureLock;
+    std::atomic<bool> ringUsed{false};
+
+    explicit TreeDeleter(DeleteStats& stats) : stats(stats) {}
+
+    void recordFailure(const std::string& path, int error) {
+        std::lock_guard<std::mutex> guard(failureLock);
+        stats.failures.push_back(path + ": " + std::strerror(error));
+    }
+
+    void unlinkFiles(int dirFd, const std::string& dirPath, const std::vector<std::string>& names, DirNode& node) {
+        if (names.empty()) return;
+        ScopedTimer timer("delete.unlink");
+        Instrumentation::add(Counter::Entries, names.size());
+#ifdef FILE_EXPLORER_HAVE_IO_URING
+        thread_local std::unique_ptr<UnlinkRing> ring;
+        thread_local bool ringUnavailable = false;
+        if (!ring && !ringUnavailable) {
+            ring = std::make_unique<UnlinkRing>();
+            if (!ring->init(256)) {
+                ring.reset();
+                ringUnavailable = true;
+            }
+        }
+        std::vector<int> results;
+        if (ring && ring->unlinkBatch(dirFd, names, results)) {
+            for (size_t i = 0; i < names.size(); i++) {
+                int result = results[i];
+                if (result == -EINVAL || result == -EOPNOTSUPP) {
+                    Instrumentation::add(Counter::Syscalls);
+                    result = unlinkat(dirFd, names[i].c_str(), 0) == 0 ? 0 : -errno;
+                } else {
+                    ringUsed = true;
+                }
+                if (result == 0) {
+                    stats.entries++;
+                } else {
+                    node.failed = true;
+                    recordFailure(dirPath + "/" + names[i], -result);
+                }
+            }
+            return;
+        }
+#endif
+        Instrumentation::add(Counter::Syscalls, names.size());
+        for (const auto& name : names) {
+            if (unlinkat(dirFd, name.c_str(), 0) == 0) {
+                stats.entries++;
+            } else {
+                node.failed = true;
+                recordFailure(dirPath + "/" + name, errno);
+            }
+        }
+    }
+
+    void processDirectory(const std::shared_ptr<DirNode>& node) {
+        ScopedTimer timer("delete.directory");
+        if (JobInterrupt::requested()) {
+            node->failed = true;
+            release(node);
+            return;
+        }
+        int fd = open(node->path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0) {
+            node->failed = true;
+            recordFailure(node->path, errno);
+            release(node);
+            return;
+        }
+
+        std::vector<char> buffer(64 * 1024);
+        std::vector<std::string> files;
+        std::vector<std::string> subdirs;
+        while (true) {
+            long bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+            Instrumentation::add(Counter::Syscalls);
+            if (bytes <= 0) break;
+            for (long offset = 0; offset < bytes;) {
+                auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+                offset += dirent->d_reclen;
+                const char* name = dirent->d_name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+                unsigned char type = dirent->d_type;
+                if (type == DT_UNKNOWN) {
+                    struct stat st;
+                    if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) type = IFTODT(st.st_mode);
+                }
+                (type == DT_DIR ? subdirs : files).emplace_back(name);
+            }
+        }
+
+        unlinkFiles(fd, node->path, files, *node);
+        close(fd);
+        Instrumentation::add(Counter::Syscalls, 2);
+
+        node->pending += static_cast<int>(subdirs.size());
+        for (const auto& name : subdirs) {
+            auto child = std::make_shared<DirNode>(node->path + "/" + name, node);
+            pool->submit([this, child] { processDirectory(child); });
+        }
+        release(node);
+    }
+
+    void release(std::shared_ptr<DirNode> node) {
+        while (node && --node->pending == 0) {
+            if (node->failed) {
+                if (node->parent) node->parent->failed = true;
+                node = node->parent;
+                continue;
+            }
+            Instrumentation::add(Counter::Syscalls);
+            if (rmdir(node->path.c_str()) == 0) {
+                stats.entries++;
+            } else {
+                recordFailure(node->path, errno);
+                if (node->parent) node->parent->failed = true;
+            }
+            node = node->parent;
+        }
+    }
+};
+
+inline void TreeCopier::moveTree(const fs::path& from, const fs::path& to, TreeCopyStats& stats,
+                                 JobJournal* journal) {
+    ScopedTimer timer("move.tree");
+    auto start = std::chrono::steady_clock::now();
+    if (rename(from.c_str(), to.c_str()) == 0) {
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return;
+    }
+    if (errno != EXDEV) {
+        throw fs::filesystem_error("cannot move", from, to, std::error_code(errno, std::generic_category()));
+    }
+
+    stats.crossDevice = true;
+    bool copied = journal && journal->reachedPhase("delete");
+    if (!copied && fs::is_directory(fs::symlink_status(from))) {
+        copyTree(from, to, stats, journal);
+    } else if (!copied) {
+        struct stat st;
+        if (lstat(from.c_str(), &st) != 0) {
+            throw fs::filesystem_error("cannot stat source", from, std::error_code(errno, std::generic_category()));
+        }
+        if (S_ISLNK(st.st_mode)) {
+            fs::copy_symlink(from, to);
+            stats.symlinks++;
+        } else {
+            CopyResult result = CopyEngine::copyFileAtomic(from, to);
+            stats.files++;
+            stats.bytes += result.bytes;
+        }
+    }
+    if (stats.errors.empty() && !stats.interrupted) {
+        if (journal) journal->markPhase("delete");
+        if (fs::is_directory(fs::symlink_status(from))) {
+            DeleteStats removed;
+            TreeDeleter::removeTree(from, removed);
+            stats.interrupted = removed.interrupted;
+            stats.errors.insert(stats.errors.end(), removed.failures.begin(), removed.failures.end());
+        } else {
+            fs::remove(from);
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+class JobRunner {
+public:
+    static void copy(const fs::path& from, const fs::path& to, TreeCopyStats& stats) {
+        JobInterrupt interrupt;
+        JobJournal journal(JobKind::Copy, from, to);
+        TreeCopier::copyTree(from, to, stats, &journal);
+        if (stats.errors.empty() && !stats.interrupted) journal.complete();
+    }
+
+    static void move(const fs::path& from, const fs::path& to, TreeCopyStats& stats) {
+        struct stat source, parent;
+        fs::path targetParent = to.has_parent_path() ? to.parent_path() : fs::path(".");
+        if (lstat(from.c_str(), &source) == 0 && stat(targetParent.c_str(), &parent) == 0 &&
+            source.st_dev == parent.st_dev) {
+            TreeCopier::moveTree(from, to, stats);
+            return;
+        }
+        JobInterrupt interrupt;
+        JobJournal journal(JobKind::Move, from, to);
+        std::error_code ec;
+        if (journal.reachedPhase("delete") && !fs::exists(fs::symlink_status(from, ec))) {
+            journal.complete();
+            return;
+        }
+        TreeCopier::moveTree(from, to, stats, &journal);
+        if (stats.errors.empty() && !stats.interrupted) journal.complete();
+    }
+
+    static void remove(const fs::path& path, DeleteStats& stats, const TreeDeleter::Progress& progress = nullptr) {
+        JobInterrupt interrupt;
+        JobJournal journal(JobKind::Delete, path, "");
+        std::error_code ec;
+        if (!journal.resumed() || fs::exists(fs::symlink_status(path, ec))) {
+            TreeDeleter::removeTree(path, stats, progress);
+        }
+        if (stats.failures.empty() && !stats.interrupted) journal.complete();
+    }
+};
+
+struct ContentSearchStats {
+    std::atomic<uintmax_t> files{0};
+    std::atomic<uintmax_t> binarySkipped{0};
+    std::atomic<uintmax_t> bytes{0};
+    std::atomic<uintmax_t> matches{0};
+    std::atomic<uintmax_t> errors{0};
+    double seconds = 0;
+
+    double gigabytesPerSecond() const {
+        return seconds > 0 ? bytes / seconds / 1e9 : 0;
+    }
+};
+
+struct ContentMatch {
+    size_t line;
+    std::string_view text;
+};
+
+class ContentSearcher {
+public:
+    using Output = std::function<void(const std::string& path, const std::vector<ContentMatch>& matches)>;
+
+    static constexpr size_t mmapThreshold = 1024 * 1024;
+    static constexpr size_t chunkBytes = 1024 * 1024;
+    static constexpr size_t binaryProbeBytes = 8 * 1024;
+    static constexpr size_t maxLineDisplay = 200;
+
+    static void search(const fs::path& root, const std::string& needle, ContentSearchStats& stats,
+                       const Output& output) {
+        ScopedTimer timer("content.search");
+        auto start = std::chrono::steady_clock::now();
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        {
+            TaskPool pool(cores, cores * 16);
+            ParallelWalker walker;
+            walker.walk(root, [&](const WalkEntry& entry) {
+                if (entry.type == DT_REG) {
+                    pool.submit([&stats, &needle, &output, path = entry.path] {
+                        searchFile(path, needle, stats, output);
+                    });
+                }
+                return true;
+            });
+            pool.wait();
+        }
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    static void searchFile(const std::string& path, const std::string& needle, ContentSearchStats& stats,
+                           const Output& output) {
+        ScopedTimer timer("content.file");
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+        if (fd < 0) {
+            stats.errors++;
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            close(fd);
+            return;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        if (size == 0) {
+            close(fd);
+            stats.files++;
+            return;
+        }
+
+        const char* data = nullptr;
+        void* mapping = MAP_FAILED;
+        thread_local std::vector<char> buffer;
+        if (size >= mmapThreshold) {
+            mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                stats.files++;
+                scanChunks(path, fd, needle, stats, output);
+                close(fd);
+                return;
+            }
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapping);
+        } else {
+            if (buffer.size() < size) buffer.resize(std::max(size, buffer.size() * 2));
+            size_t filled = 0;
+            while (filled < size) {
+                ssize_t n = read(fd, buffer.data() + filled, size - filled);
+                if (n <= 0) break;
+                filled += static_cast<size_t>(n);
+            }
+            size = filled;
+            data = buffer.data();
+        }
+        close(fd);
+
+        stats.files++;
+        if (std::memchr(data, '\0', std::min(size, binaryProbeBytes))) {
+            stats.binarySkipped++;
+        } else {
+            stats.bytes += size;
+            Instrumentation::add(Counter::Bytes, size);
+            scan(path, std::string_view(data, size), needle, stats, output);
+        }
+        if (mapping != MAP_FAILED) munmap(mapping, static_cast<size_t>(st.st_size));
+    }
+
+    static void scanChunks(const std::string& path, int fd, const std::string& needle, ContentSearchStats& stats,
+                           const Output& output) {
+        std::vector<char> chunk(chunkBytes);
+        std::deque<std::string> lines;
+        std::vector<ContentMatch> found;
+        size_t carried = 0;
+        size_t lineNumber = 1;
+        bool probed = false;
+        while (true) {
+            ssize_t n = read(fd, chunk.data() + carried, chunk.size() - carried);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                stats.errors++;
+                return;
+            }
+            size_t filled = carried + static_cast<size_t>(n);
+            bool end = n == 0;
+            if (!probed) {
+                if (std::memchr(chunk.data(), '\0', std::min(filled, binaryProbeBytes))) {
+                    stats.binarySkipped++;
+                    return;
+                }
+                probed = true;
+            }
+            std::string_view text(chunk.data(), filled);
+            size_t cut = filled;
+            size_t scanned = filled;
+            if (!end) {
+                size_t newline = text.rfind('\n');
+                if (newline != std::string_view::npos) {
+                    cut = scanned = newline + 1;
+                } else if (filled < chunk.size()) {
+                    carried = filled;
+                    continue;
+                } else {
+                    cut = filled - std::min(filled, needle.empty() ? 0 : needle.size() - 1);
+                }
+            }
+
+            std::string_view part = text.substr(0, scanned);
+            size_t skip = 0;
+            if (!found.empty() && found.back().line == lineNumber) {
+                skip = part.find('\n');
+                skip = skip == std::string_view::npos ? part.size() : skip + 1;
+            }
+            size_t before = found.size();
+            collect(part.substr(skip), needle, lineNumber + (skip > 0 ? 1 : 0), stats, found);
+            for (size_t i = before; i < found.size(); i++) {
+                lines.emplace_back(found[i].text);
+                found[i].text = lines.back();
+            }
+            lineNumber += static_cast<size_t>(std::count(part.begin(), part.end(), '\n'));
+            stats.bytes += cut;
+            Instrumentation::add(Counter::Bytes, cut);
+
+            carried = filled - cut;
+            std::memmove(chunk.data(), chunk.data() + cut, carried);
+            if (end) break;
+        }
+        if (!found.empty()) output(path, found);
+    }
+
+    static void scan(const std::string& path, std::string_view text, const std::string& needle,
+                     ContentSearchStats& stats, const Output& output) {
+        std::vector<ContentMatch> found;
+        collect(text, needle, 1, stats, found);
+        if (!found.empty()) output(path, found);
+    }
+
+    static void collect(std::string_view text, const std::string& needle, size_t lineNumber,
+                        ContentSearchStats& stats, std::vector<ContentMatch>& found) {
+        size_t counted = 0;
+        size_t position = 0;
+        while (position < text.size()) {
+            size_t hit = findLiteral(text.substr(position), needle);
+            if (hit == std::string_view::npos) break;
+            hit += position;
+
+            lineNumber += static_cast<size_t>(std::count(text.begin() + counted, text.begin() + hit, '\n'));
+            size_t lineStart = text.rfind('\n', hit);
+            lineStart = lineStart == std::string_view::npos ? 0 : lineStart + 1;
+            size_t lineEnd = text.find('\n', hit);
+            if (lineEnd == std::string_view::npos) lineEnd = text.size();
+
+            found.push_back(ContentMatch{lineNumber, text.substr(lineStart, std::min(lineEnd - lineStart, maxLineDisplay))});
+            stats.matches++;
+
+            counted = hit;
+            position = lineEnd + 1;
+        }
+    }
+};
+
+class SizeTree {
+public:
+    struct Node {
+        uint32_t parent;
+        uint32_t firstChild;
+        uint32_t nextSibling;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint64_t ownBytes;
+        uint64_t totalBytes;
+        uint64_t files;
+        uint64_t totalFiles;
+    };
+
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    void build(const fs::path& root) {
+        ScopedTimer timer("sizetree.build");
+        rootPath = root.string();
+        nodes.clear();
+        names.clear();
+        builtAt = std::chrono::steady_clock::now();
+        std::unordered_map<std::string, uint32_t> nodeByPath;
+        std::set<std::pair<uint64_t, uint64_t>> seenLinks;
+        std::mutex lock;
+
+        struct stat rootStat;
+        addNode(none, rootPath, lstat(rootPath.c_str(), &rootStat) == 0 ? diskBytes(rootStat) : 0);
+        nodeByPath.emplace(rootPath, 0);
+
+        ParallelWalker walker;
+        walker.walk(root, [&](const WalkEntry& entry) {
+            struct stat st;
+            if (fstatat(entry.dirFd, entry.name, &st, AT_SYMLINK_NOFOLLOW) != 0) return false;
+            std::string parentPath = entry.path.substr(0, entry.path.size() - std::strlen(entry.name) - 1);
+            if (parentPath.empty()) parentPath = "/";
+            uint64_t bytes = diskBytes(st);
+
+            std::lock_guard<std::mutex> guard(lock);
+            auto parent = nodeByPath.find(parentPath);
+            if (parent == nodeByPath.end()) return false;
+            if (S_ISDIR(st.st_mode)) {
+                nodeByPath.emplace(entry.path, addNode(parent->second, entry.name, bytes));
+                return true;
+            }
+            if (st.st_nlink > 1 && !seenLinks.insert({st.st_dev, st.st_ino}).second) return false;
+            nodes[parent->second].ownBytes += bytes;
+            nodes[parent->second].files++;
+            return false;
+        });
+
+        for (size_t i = nodes.size(); i-- > 0;) {
+            Node& node = nodes[i];
+            node.totalBytes += node.ownBytes;
+            node.totalFiles += node.files;
+            if (node.parent != none) {
+                nodes[node.parent].totalBytes += node.totalBytes;
+                nodes[node.parent].totalFiles += node.totalFiles;
+            }
+        }
+    }
+
+    bool empty() const { return nodes.empty(); }
+    const Node& node(uint32_t index) const { return nodes[index]; }
+    size_t directoryCount() const { return nodes.size(); }
+    double ageSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - builtAt).count();
+    }
+
+    std::string_view name(uint32_t index) const {
+        return std::string_view(names).substr(nodes[index].nameOffset, nodes[index].nameLength);
+    }
+
+    uint32_t find(const fs::path& path) const {
+        if (nodes.empty()) return none;
+        fs::path relative = path.lexically_relative(rootPath);
+        if (relative.empty() || *relative.begin() == "..") return none;
+        uint32_t current = 0;
+        for (const auto& component : relative) {
+            if (component == ".") continue;
+            uint32_t child = nodes[current].firstChild;
+            while (child != none && name(child) != component.string()) child = nodes[child].nextSibling;
+            if (child == none) return none;
+            current = child;
+        }
+        return current;
+    }
+
+    std::vector<uint32_t> children(uint32_t index) const {
+        std::vector<uint32_t> result;
+        for (uint32_t child = nodes[index].firstChild; child != none; child = nodes[child].nextSibling) {
+            result.push_back(child);
+        }
+        std::sort(result.begin(), result.end(),
+            [this](uint32_t a, uint32_t b) { return nodes[a].totalBytes > nodes[b].totalBytes; });
+        return result;
+    }
+
+    std::vector<uint32_t> heaviestSubtrees(uint32_t index, size_t count) const {
+        std::vector<uint32_t> descendants;
+        std::vector<uint32_t> stack{index};
+        while (!stack.empty()) {
+            uint32_t current = stack.back();
+            stack.pop_back();
+            for (uint32_t child = nodes[current].firstChild; child != none; child = nodes[child].nextSibling) {
+                descendants.push_back(child);
+                stack.push_back(child);
+            }
+        }
+        count = std::min(count, descendants.size());
+        std::partial_sort(descendants.begin(), descendants.begin() + count, descendants.end(),
+            [this](uint32_t a, uint32_t b) { return nodes[a].totalBytes > nodes[b].totalBytes; });
+        descendants.resize(count);
+        return descendants;
+    }
+
+    std::string pathOf(uint32_t index) const {
+        std::vector<std::string_view> parts;
+        for (uint32_t current = index; current != 0 && current != none; current = nodes[current].parent) {
+            parts.push_back(name(current));
+        }
+        std::string path = rootPath;
+        for (auto it = parts.rbegin(); it != parts.rend(); ++it) {
+            if (path.back() != '/') path += '/';
+            path.append(*it);
+        }
+        return path;
+    }
+
+private:
+    std::string rootPath;
+    std::vector<Node> nodes;
+    std::string names;
+    std::chrono::steady_clock::time_point builtAt;
+
+    static uint64_t diskBytes(const struct stat& st) {
+        return static_cast<uint64_t>(st.st_blocks) * 512;
+    }
+
+    uint32_t addNode(uint32_t parent, std::string_view name, uint64_t ownBytes) {
+        uint32_t index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{parent, none, none, static_cast<uint32_t>(names.size()),
+                             static_cast<uint32_t>(name.size()), ownBytes, 0, 0, 0});
+        names.append(name);
+        if (parent != none) {
+            nodes[index].nextSibling = nodes[parent].firstChild;
+            nodes[parent].firstChild = index;
+        }
+        return index;
+    }
+};
+
+class FastHash {
+public:
+    static constexpr size_t fileChunkBytes = 1024 * 1024;
+
+    static bool hashFile(const std::string& path, uint64_t expectedSize, uint64_t& out) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+        if (fd < 0) return false;
+        uint64_t hash = expectedSize;
+        size_t size = static_cast<size_t>(expectedSize);
+        bool ok = true;
+        void* mapping = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            const char* data = static_cast<const char*>(mapping);
+            for (size_t offset = 0; offset < size; offset += fileChunkBytes) {
+                hash = FastHash::hash(data + offset, std::min(fileChunkBytes, size - offset), hash);
+            }
+            munmap(mapping, size);
+        } else {
+            thread_local std::vector<char> buffer(fileChunkBytes);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            ssize_t got;
+            size_t total = 0;
+            while ((got = read(fd, buffer.data(), buffer.size())) > 0) {
+                hash = FastHash::hash(buffer.data(), static_cast<size_t>(got), hash);
+                total += static_cast<size_t>(got);
+            }
+            ok = got >= 0 && total == size;
+        }
+        close(fd);
+        Instrumentation::add(Counter::Bytes, size);
+        out = hash;
+        return ok;
+    }
+
+    static uint64_t hash(const void* input, size_t length, uint64_t seed = 0) {
+        const unsigned char* p = static_cast<const unsigned char*>(input);
+        const unsigned char* end = p + length;
+        uint64_t h;
+        if (length >= 32) {
+            uint64_t v1 = seed + prime1 + prime2;
+            uint64_t v2 = seed + prime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - prime1;
+            const unsigned char* limit = end - 32;
+            do {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = mergeRound(h, v1);
+            h = mergeRound(h, v2);
+            h = mergeRound(h, v3);
+            h = mergeRound(h, v4);
+        } else {
+            h = seed + prime5;
+        }
+        h += static_cast<uint64_t>(length);
+
+        for (; p + 8 <= end; p += 8) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * prime1 + prime4;
+        }
+        if (p + 4 <= end) {
+            h ^= static_cast<uint64_t>(read32(p)) * prime1;
+            h = rotl(h, 23) * prime2 + prime3;
+            p += 4;
+        }
+        for (; p < end; p++) {
+            h ^= (*p) * prime5;
+            h = rotl(h, 11) * prime1;
+        }
+        h ^= h >> 33;
+        h *= prime2;
+        h ^= h >> 29;
+        h *= prime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    static uint64_t read64(const unsigned char* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t read32(const unsigned char* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * prime2;
+        acc = rotl(acc, 31);
+        return acc * prime1;
+    }
+
+    static uint64_t mergeRound(uint64_t acc, uint64_t value) {
+        acc ^= round(0, value);
+        return acc * prime1 + prime4;
+    }
+};
+
+struct DuplicateSet {
+    uint64_t size;
+    std::vector<std::string> paths;
+
+    uint64_t reclaimableBytes() const { return size * (paths.size() - 1); }
+};
+
+struct DuplicateStats {
+    uintmax_t filesScanned = 0;
+    uintmax_t sizeCandidates = 0;
+    uintmax_t partialCandidates = 0;
+    std::atomic<uintmax_t> bytesHashed{0};
+    std::atomic<uintmax_t> errors{0};
+    uint64_t reclaimableBytes = 0;
+    double seconds = 0;
+};
+
+class DuplicateFinder {
+public:
+    static constexpr size_t edgeBytes = 4096;
+
+    static std::vector<DuplicateSet> find(const fs::path& root, DuplicateStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Candidate> files = collect(root, stats);
+        stats.filesScanned = files.size();
+
+        std::vector<std::vector<Candidate*>> groups = groupBy(files, [](const Candidate& c) { return c.size; });
+        stats.sizeCandidates = countMembers(groups);
+
+        {
+            ScopedTimer timer("duplicates.partial");
+            hashGroups(groups, stats, false);
+        }
+        groups = regroup(groups, [](const Candidate& c) { return std::make_pair(c.size, c.partialHash); });
+        stats.partialCandidates = countMembers(groups);
+
+        {
+            ScopedTimer timer("duplicates.full");
+            hashGroups(groups, stats, true);
+        }
+        groups = regroup(groups, [](const Candidate& c) { return std::make_pair(c.size, c.fullHash); });
+
+        std::vector<DuplicateSet> sets;
+        for (const auto& group : groups) {
+            DuplicateSet set{group.front()->size, {}};
+            for (const Candidate* candidate : group) set.paths.push_back(candidate->path);
+            std::sort(set.paths.begin(), set.paths.end());
+            stats.reclaimableBytes += set.reclaimableBytes();
+            sets.push_back(std::move(set));
+        }
+        std::sort(sets.begin(), sets.end(), [](const DuplicateSet& a, const DuplicateSet& b) {
+            return a.reclaimableBytes() > b.reclaimableBytes();
+        });
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return sets;
+    }
+
+private:
+    struct Candidate {
+        std::string path;
+        uint64_t size;
+        uint64_t device;
+        uint64_t inode;
+        uint64_t partialHash = 0;
+        uint64_t fullHash = 0;
+        bool failed = false;
+    };
+
+    static std::vector<Candidate> collect(const fs::path& root, DuplicateStats& stats) {
+        std::vector<Candidate> files;
+        std::set<std::pair<uint64_t, uint64_t>> seen;
+        std::mutex lock;
+        ParallelWalker walker;
+        walker.walk(root, [&](const WalkEntry& entry) {
+            if (entry.type != DT_REG) return true;
+            struct stat st;
+            if (fstatat(entry.dirFd, entry.name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                stats.errors++;
+                return true;
+            }
+            if (st.st_size == 0) return true;
+            std::lock_guard<std::mutex> guard(lock);
+            if (seen.insert({st.st_dev, st.st_ino}).second) {
+                files.push_back(Candidate{entry.path, static_cast<uint64_t>(st.st_size),
+                                          static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)});
+            }
+            return true;
+        });
+        return files;
+    }
+
+    template <typename KeyFunction>
+    static std::vector<std::vector<Candidate*>> groupBy(std::vector<Candidate>& files, KeyFunction key) {
+        std::vector<Candidate*> all;
+        for (auto& file : files) all.push_back(&file);
+        return split(all, key);
+    }
+
+    template <typename KeyFunction>
+    static std::vector<std::vector<Candidate*>> regroup(const std::vector<std::vector<Candidate*>>& groups,
+                                                        KeyFunction key) {
+        std::vector<std::vector<Candidate*>> result;
+        for (const auto& group : groups) {
+            std::vector<Candidate*> live;
+            for (Candidate* candidate : group) {
+                if (!candidate->failed) live.push_back(candidate);
+            }
+            for (auto& subgroup : split(live, key)) result.push_back(std::move(subgroup));
+        }
+        return result;
+    }
+
+    template <typename KeyFunction>
+    static std::vector<std::vector<Candidate*>> split(std::vector<Candidate*>& members, KeyFunction key) {
+        std::sort(members.begin(), members.end(),
+            [&](const Candidate* a, const Candidate* b) { return key(*a) < key(*b); });
+        std::vector<std::vector<Candidate*>> result;
+        for (size_t i = 0; i < members.size();) {
+            size_t j = i + 1;
+            while (j < members.size() && key(*members[j]) == key(*members[i])) j++;
+            if (j - i > 1) result.emplace_back(members.begin() + i, members.begin() + j);
+            i = j;
+        }
+        return result;
+    }
+
+    static size_t countMembers(const std::vector<std::vector<Candidate*>>& groups) {
+        size_t count = 0;
+        for (const auto& group : groups) count += group.size();
+        return count;
+    }
+
+    static void hashGroups(std::vector<std::vector<Candidate*>>& groups, DuplicateStats& stats, bool full) {
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        TaskPool pool(std::max(2u, cores), cores * 8);
+        for (auto& group : groups) {
+            for (Candidate* candidate : group) {
+                if (full && candidate->size <= 2 * edgeBytes) {
+                    candidate->fullHash = candidate->partialHash;
+                    continue;
+                }
+                pool.submit([candidate, &stats, full] {
+                    if (full) hashFull(*candidate, stats);
+                    else hashEdges(*candidate, stats);
+                });
+            }
+        }
+        pool.wait();
+    }
+
+    static void hashEdges(Candidate& candidate, DuplicateStats& stats) {
+        int fd = open(candidate.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            candidate.failed = true;
+            stats.errors++;
+            return;
+        }
+        char buffer[2 * edgeBytes];
+        size_t head = candidate.size <= 2 * edgeBytes ? static_cast<size_t>(candidate.size) : edgeBytes;
+        ssize_t got = pread(fd, buffer, head, 0);
+        if (got >= 0 && candidate.size > 2 * edgeBytes) {
+            ssize_t tail = pread(fd, buffer + got, edgeBytes, static_cast<off_t>(candidate.size - edgeBytes));
+            got = tail < 0 ? -1 : got + tail;
+        }
+        close(fd);
+        if (got < 0) {
+            candidate.failed = true;
+            stats.errors++;
+            return;
+        }
+        stats.bytesHashed += static_cast<uintmax_t>(got);
+        candidate.partialHash = FastHash::hash(buffer, static_cast<size_t>(got), candidate.size);
+    }
+
+    static void hashFull(Candidate& candidate, DuplicateStats& stats) {
+        if (!FastHash::hashFile(candidate.path, candidate.size, candidate.fullHash)) {
+            candidate.failed = true;
+            stats.errors++;
+            return;
+        }
+        stats.bytesHashed += candidate.size;
+    }
+};
+
+class ModeSpec {
+public:
+    explicit ModeSpec(const std::string& text) : spec(text) {
+        if (!text.empty() && text.find_first_not_of("01234567") == std::string::npos) {
+            if (text.size() > 4) throw std::invalid_argument("invalid mode: " + text);
+            absolute = true;
+            octal = static_cast<mode_t>(std::stoul(text, nullptr, 8));
+            return;
+        }
+        mode_t mask = processUmask;
+        size_t i = 0;
+        while (i <= text.size()) {
+            Clause clause;
+            for (; i < text.size() && std::strchr("ugoa", text[i]); i++) {
+                switch (text[i]) {
+                    case 'u': clause.who |= S_ISUID | S_IRWXU; break;
+                    case 'g': clause.who |= S_ISGID | S_IRWXG; break;
+                    case 'o': clause.who |= S_ISVTX | S_IRWXO; break;
+                    case 'a': clause.who |= 07777; break;
+                }
+            }
+            if (clause.who == 0) {
+                clause.who = 07777;
+                clause.umask = mask;
+            }
+            if (i >= text.size() || !std::strchr("+-=", text[i])) throw std::invalid_argument("invalid mode: " + text);
+            while (i < text.size() && std::strchr("+-=", text[i])) {
+                Action action{text[i++], 0, false};
+                for (; i < text.size() && std::strchr("rwxXst", text[i]); i++) {
+                    switch (text[i]) {
+                        case 'r': action.bits |= 0444; break;
+                        case 'w': action.bits |= 0222; break;
+                        case 'x': action.bits |= 0111; break;
+                        case 'X': action.conditionalExecute = true; break;
+                        case 's': action.bits |= S_ISUID | S_ISGID; break;
+                        case 't': action.bits |= S_ISVTX; break;
+                    }
+                }
+                clause.actions.push_back(action);
+            }
+            clauses.push_back(std::move(clause));
+            if (i == text.size()) break;
+            if (text[i] != ',') throw std::invalid_argument("invalid mode: " + text);
+            i++;
+        }
+    }
+
+    mode_t apply(mode_t current, bool isDirectory) const {
+        mode_t mode = current & 07777;
+        if (absolute) return octal;
+        for (const auto& clause : clauses) {
+            for (const auto& action : clause.actions) {
+                mode_t bits = action.bits;
+                if (action.conditionalExecute && (isDirectory || (mode & 0111))) bits |= 0111;
+                bits &= clause.who & ~(clause.umask & 0777);
+                switch (action.op) {
+                    case '+': mode |= bits; break;
+                    case '-': mode &= ~bits; break;
+                    case '=':
+                        mode &= ~(clause.who & (isDirectory ? 01777 : 07777));
+                        mode |= bits;
+                        break;
+                }
+            }
+        }
+        return mode;
+    }
+
+    const std::string& text() const { return spec; }
+
+private:
+    static mode_t readUmask() {
+        mode_t mask = umask(0);
+        umask(mask);
+        return mask;
+    }
+
+    static inline const mode_t processUmask = readUmask();
+
+    struct Action {
+        char op;
+        mode_t bits;
+        bool conditionalExecute;
+    };
+
+    struct Clause {
+        mode_t who = 0;
+        mode_t umask = 0;
+        std::vector<Action> actions;
+    };
+
+    std::string spec;
+    bool absolute = false;
+    mode_t octal = 0;
+    std::vector<Clause> clauses;
+};
+
+struct Ownership {
+    uid_t user = static_cast<uid_t>(-1);
+    gid_t group = static_cast<gid_t>(-1);
+
+    static Ownership parse(const std::string& text) {
+        Ownership owner;
+        size_t colon = text.find(':');
+        std::string userName = text.substr(0, colon);
+        std::string groupName = colon == std::string::npos ? "" : text.substr(colon + 1);
+        if (!userName.empty()) {
+            if (userName.find_first_not_of("0123456789") == std::string::npos) {
+                owner.user = static_cast<uid_t>(std::stoul(userName));
+            } else if (struct passwd* pw = getpwnam(userName.c_str())) {
+                owner.user = pw->pw_uid;
+            } else {
+                throw std::invalid_argument("unknown user: " + userName);
+            }
+        }
+        if (!groupName.empty()) {
+            if (groupName.find_first_not_of("0123456789") == std::string::npos) {
+                owner.group = static_cast<gid_t>(std::stoul(groupName));
+            } else if (struct group* gr = getgrnam(groupName.c_str())) {
+                owner.group = gr->gr_gid;
+            } else {
+                throw std::invalid_argument("unknown group: " + groupName);
+            }
+        }
+        return owner;
+    }
+
+    bool changes() const { return user != static_cast<uid_t>(-1) || group != static_cast<gid_t>(-1); }
+
+    bool matches(const struct stat& st) const {
+        return (user == static_cast<uid_t>(-1) || user == st.st_uid) &&
+               (group == static_cast<gid_t>(-1) || group == st.st_gid);
+    }
+};
+
+struct BulkChangeOptions {
+    const ModeSpec* fileMode = nullptr;
+    const ModeSpec* directoryMode = nullptr;
+    Ownership owner;
+    const NameMatcher* filter = nullptr;
+    bool recursive = true;
+};
+
+struct BulkChangeStats {
+    std::atomic<uintmax_t> examined{0};
+    std::atomic<uintmax_t> changed{0};
+    std::atomic<uintmax_t> unchanged{0};
+    std::atomic<uintmax_t> filtered{0};
+    std::vector<std::string> failures;
+    double seconds = 0;
+};
+
+class BulkAttributeChanger {
+public:
+    static void apply(const fs::path& root, const BulkChangeOptions& options, BulkChangeStats& stats) {
+        ScopedTimer timer("chmod.tree");
+        auto start = std::chrono::steady_clock::now();
+        BulkAttributeChanger changer(options, stats);
+
+        struct stat rootStat;
+        if (lstat(root.c_str(), &rootStat) != 0) {
+            changer.recordFailure(root.string(), errno);
+        } else {
+            changer.visit(AT_FDCWD, root.c_str(), root.filename().string(), root.string(), rootStat, 0);
+            if (options.recursive && S_ISDIR(rootStat.st_mode)) {
+                ParallelWalker walker;
+                walker.walk(root, [&](const WalkEntry& entry) {
+                    if (entry.type != DT_REG && entry.type != DT_DIR) return false;
+                    struct stat st;
+                    if (fstatat(entry.dirFd, entry.name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                        changer.recordFailure(entry.path, errno);
+                        return false;
+                    }
+                    changer.visit(entry.dirFd, entry.name, entry.name, entry.path, st, entry.depth);
+                    return true;
+                });
+                if (walker.errorCount() > 0) {
+                    changer.recordFailure(root.string() + " (" + std::to_string(walker.errorCount()) +
+                                          " unreadable director(ies))", EACCES);
+                }
+            }
+        }
+        changer.applyDeferredDirectories();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    struct DeferredDirectory {
+        int depth;
+        std::string path;
+        mode_t mode;
+    };
+
+    const BulkChangeOptions& options;
+    BulkChangeStats& stats;
+    std::mutex lock;
+    std::vector<DeferredDirectory> deferred;
+
+    BulkAttributeChanger(const BulkChangeOptions& options, BulkChangeStats& stats) : options(options), stats(stats) {}
+
+    void visit(int dirFd, const char* name, std::string_view displayName, const std::string& path,
+               const struct stat& st, int depth) {
+        bool isDirectory = S_ISDIR(st.st_mode);
+        if (!isDirectory && !S_ISREG(st.st_mode)) return;
+        stats.examined++;
+        if (options.filter && !options.filter->matches(displayName)) {
+            stats.filtered++;
+            return;
+        }
+
+        const ModeSpec* spec = isDirectory ? options.directoryMode : options.fileMode;
+        mode_t target = spec ? spec->apply(st.st_mode, isDirectory) : (st.st_mode & 07777);
+        bool modeChanges = target != (st.st_mode & 07777);
+        bool ownerChanges = options.owner.changes() && !options.owner.matches(st);
+        if (!modeChanges && !ownerChanges) {
+            stats.unchanged++;
+            return;
+        }
+
+        if (ownerChanges) {
+            Instrumentation::add(Counter::Syscalls);
+            if (fchownat(dirFd, name, options.owner.user, options.owner.group, AT_SYMLINK_NOFOLLOW) != 0) {
+                recordFailure(path, errno);
+                return;
+            }
+        }
+        if (modeChanges && isDirectory) {
+            std::lock_guard<std::mutex> guard(lock);
+            deferred.push_back(DeferredDirectory{depth, path, target});
+            return;
+        }
+        if (modeChanges) {
+            Instrumentation::add(Counter::Syscalls);
+            if (fchmodat(dirFd, name, target, 0) != 0) {
+                recordFailure(path, errno);
+                return;
+            }
+        }
+        stats.changed++;
+    }
+
+    void applyDeferredDirectories() {
+        std::sort(deferred.begin(), deferred.end(), [](const DeferredDirectory& a, const DeferredDirectory& b) {
+            return a.depth > b.depth;
+        });
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < deferred.size();) {
+            size_t end = i;
+            while (end < deferred.size() && deferred[end].depth == deferred[i].depth) end++;
+            TaskPool pool(std::max(2u, cores), cores * 8);
+            for (size_t j = i; j < end; j++) {
+                pool.submit([this, &entry = deferred[j]] {
+                    Instrumentation::add(Counter::Syscalls);
+                    if (fchmodat(AT_FDCWD, entry.path.c_str(), entry.mode, 0) == 0) {
+                        stats.changed++;
+                    } else {
+                        recordFailure(entry.path, errno);
+                    }
+                });
+            }
+            pool.wait();
+            i = end;
+        }
+    }
+
+    void recordFailure(const std::string& path, int error) {
+        std::lock_guard<std::mutex> guard(lock);
+        stats.failures.push_back(path + ": " + std::strerror(error));
+    }
+};
+
+struct QueryMatch {
+    std::string path;
+    unsigned char type;
+    uint64_t size;
+    int64_t mtime;
+    uint32_t mode;
+    int depth;
+};
+
+struct QueryStats {
+    std::atomic<uintmax_t> visited{0};
+    std::atomic<uintmax_t> statCalls{0};
+    std::atomic<uintmax_t> pruned{0};
+    std::atomic<uintmax_t> matches{0};
+    double seconds = 0;
+};
+
+class FileQuery {
+public:
+    enum class SortKey { None, Size, Mtime };
+
+    explicit FileQuery(const std::string& text) {
+        excludes = {"node_modules", ".git"};
+        std::istringstream stream(text);
+        std::string term;
+        while (stream >> term) parseTerm(term);
+        if (sortKey != SortKey::None && limit == 0) limit = 20;
+    }
+
+    bool sorted() const { return sortKey != SortKey::None; }
+
+    void run(const fs::path& root, QueryStats& stats, const std::function<void(const QueryMatch&)>& output) const {
+        ScopedTimer timer("query.run");
+        auto start = std::chrono::steady_clock::now();
+        int64_t now = static_cast<int64_t>(std::time(nullptr));
+        std::vector<NameMatcher> excludeMatchers;
+        for (const auto& pattern : excludes) excludeMatchers.emplace_back(pattern, MatchMode::Glob);
+        std::unique_ptr<NameMatcher> nameMatcher;
+        if (!namePattern.empty()) nameMatcher = std::make_unique<NameMatcher>(namePattern, nameMode);
+
+        auto better = [this](const QueryMatch& a, const QueryMatch& b) {
+            int64_t left = sortKey == SortKey::Size ? static_cast<int64_t>(a.size) : a.mtime;
+            int64_t right = sortKey == SortKey::Size ? static_cast<int64_t>(b.size) : b.mtime;
+            return ascending ? left < right : left > right;
+        };
+        std::priority_queue<QueryMatch, std::vector<QueryMatch>, decltype(better)> best(better);
+        std::mutex lock;
+
+        ParallelWalker walker;
+        walker.walk(root, [&](const WalkEntry& entry) {
+            stats.visited++;
+            bool isDirectory = entry.type == DT_DIR;
+            for (const auto& exclude : excludeMatchers) {
+                if (exclude.matches(entry.name)) {
+                    stats.pruned++;
+                    return false;
+                }
+            }
+            bool descend = isDirectory && entry.depth < depth.max;
+            if (entry.depth < depth.min || entry.depth > depth.max) return descend;
+            if (!types.empty() && types.find(typeLetter(entry.type)) == std::string::npos) return descend;
+            if (nameMatcher && !nameMatcher->matches(entry.name)) return descend;
+
+            QueryMatch match{entry.path, entry.type, 0, 0, 0, entry.depth};
+            if (needsStat()) {
+                struct stat st;
+                stats.statCalls++;
+                if (fstatat(entry.dirFd, entry.name, &st, AT_SYMLINK_NOFOLLOW) != 0) return descend;
+                match.size = static_cast<uint64_t>(st.st_size);
+                match.mtime = static_cast<int64_t>(st.st_mtime);
+                match.mode = st.st_mode & 07777;
+                if (!size.contains(static_cast<int64_t>(match.size))) return descend;
+                if (!age.contains(now - match.mtime)) return descend;
+                if (!permissionsMatch(match.mode)) return descend;
+            }
+            stats.matches++;
+
+            std::lock_guard<std::mutex> guard(lock);
+            if (!sorted()) {
+                output(match);
+            } else if (best.size() < limit) {
+                best.push(std::move(match));
+            } else if (better(match, best.top())) {
+                best.pop();
+                best.push(std::move(match));
+            }
+            return descend;
+        });
+
+        std::vector<QueryMatch> ordered;
+        for (; !best.empty(); best.pop()) ordered.push_back(best.top());
+        for (auto it = ordered.rbegin(); it != ordered.rend(); ++it) output(*it);
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static const char* syntax() {
+        return "  name:GLOB  iname:GLOB  regex:RE  (a bare word matches names as a glob or substring)\n"
+               "  type:f|d|l    size>10M  size<=4k    mtime<7d  mtime>1w   (s m h d w)\n"
+               "  perm:755 (exact)  perm:-111 (all bits)  perm:/022 (any bit)   depth<=3\n"
+               "  exclude:GLOB (default .git, node_modules; exclude:none clears)\n"
+               "  sort:size|mtime (largest/newest first; sort:+size for smallest)  top:N\n";
+    }
+
+private:
+    struct Range {
+        int64_t min = std::numeric_limits<int64_t>::min();
+        int64_t max = std::numeric_limits<int64_t>::max();
+        bool set = false;
+
+        bool contains(int64_t value) const { return value >= min && value <= max; }
+    };
+
+    std::string namePattern;
+    MatchMode nameMode = MatchMode::Substring;
+    std::string types;
+    Range size;
+    Range age;
+    Range depth{1, std::numeric_limits<int>::max(), false};
+    char permOp = 0;
+    uint32_t permBits = 0;
+    std::vector<std::string> excludes;
+    SortKey sortKey = SortKey::None;
+    bool ascending = false;
+    size_t limit = 0;
+
+    bool needsStat() const { return size.set || age.set || permOp != 0 || sorted(); }
+
+    bool permissionsMatch(uint32_t mode) const {
+        switch (permOp) {
+            case '=': return mode == permBits;
+            case '-': return (mode & permBits) == permBits;
+            case '/': return (mode & permBits) != 0;
+        }
+        return true;
+    }
+
+    static char typeLetter(unsigned char type) {
+        switch (type) {
+            case DT_REG: return 'f';
+            case DT_DIR: return 'd';
+            case DT_LNK: return 'l';
+            default: return '?';
+        }
+    }
+
+    static int64_t parseNumber(const std::string& text, const std::string& term, bool duration) {
+        size_t end = 0;
+        double value;
+        try {
+            value = std::stod(text, &end);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("invalid value in: " + term);
+        }
+        std::string unit = text.substr(end);
+        double scale = 1;
+        if (duration) {
+            if (unit == "" || unit == "s") scale = 1;
+            else if (unit == "m") scale = 60;
+            else if (unit == "h") scale = 3600;
+            else if (unit == "d") scale = 86400;
+            else if (unit == "w") scale = 7 * 86400;
+            else throw std::invalid_argument("invalid time unit in: " + term);
+        } else {
+            if (!unit.empty() && (unit.back() == 'B' || unit.back() == 'b')) unit.pop_back();
+            if (unit == "") scale = 1;
+            else if (unit == "k" || unit == "K") scale = 1024.0;
+            else if (unit == "M") scale = 1024.0 * 1024;
+            else if (unit == "G") scale = 1024.0 * 1024 * 1024;
+            else if (unit == "T") scale = 1024.0 * 1024 * 1024 * 1024;
+            else throw std::invalid_argument("invalid size unit in: " + term);
+        }
+        return static_cast<int64_t>(value * scale);
+    }
+
+    static void parseRange(Range& range, const std::string& term, size_t keyLength, bool duration) {
+        std::string rest = term.substr(keyLength);
+        std::string op;
+        while (!rest.empty() && std::strchr("<>=:", rest.front())) {
+            op += rest.front();
+            rest.erase(0, 1);
+        }
+        int64_t value = parseNumber(rest, term, duration);
+        if (op == ">") range.min = std::max(range.min, value + 1);
+        else if (op == ">=") range.min = std::max(range.min, value);
+        else if (op == "<") range.max = std::min(range.max, value - 1);
+        else if (op == "<=") range.max = std::min(range.max, value);
+        else if (op == "=" || op == ":") range.min = range.max = value;
+        else throw std::invalid_argument("invalid comparison in: " + term);
+        range.set = true;
+    }
+
+    static bool startsWith(const std::string& text, const char* prefix) {
+        return text.rfind(prefix, 0) == 0;
+    }
+
+    void parseTerm(const std::string& term) {
+        if (startsWith(term, "name:")) {
+            namePattern = term.substr(5);
+            nameMode = MatchMode::Glob;
+        } else if (startsWith(term, "iname:")) {
+            namePattern = term.substr(6);
+            nameMode = namePattern.find_first_of("*?[") == std::string::npos ? MatchMode::IgnoreCase : MatchMode::Glob;
+            if (nameMode == MatchMode::Glob) {
+                std::string folded;
+                bool inClass = false;
+                for (char c : namePattern) {
+                    if (c == '[' || c == ']') inClass = c == '[';
+                    if (!inClass && std::isalpha(static_cast<unsigned char>(c))) {
+                        folded += '[';
+                        folded += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                        folded += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                        folded += ']';
+                    } else {
+                        folded += c;
+                    }
+                }
+                namePattern = folded;
+            }
+        } else if (startsWith(term, "regex:")) {
+            namePattern = term.substr(6);
+            nameMode = MatchMode::Regex;
+        } else if (startsWith(term, "type:")) {
+            types = term.substr(5);
+            if (types.empty() || types.find_first_not_of("fdl") != std::string::npos) {
+                throw std::invalid_argument("type must be f, d or l: " + term);
+            }
+        } else if (startsWith(term, "size")) {
+            parseRange(size, term, 4, false);
+        } else if (startsWith(term, "mtime")) {
+            parseRange(age, term, 5, true);
+        } else if (startsWith(term, "depth")) {
+            parseRange(depth, term, 5, false);
+        } else if (startsWith(term, "perm:")) {
+            std::string bits = term.substr(5);
+            permOp = '=';
+            if (!bits.empty() && (bits[0] == '-' || bits[0] == '/')) {
+                permOp = bits[0];
+                bits.erase(0, 1);
+            }
+            if (bits.empty() || bits.size() > 4 || bits.find_first_not_of("01234567") != std::string::npos) {
+                throw std::invalid_argument("perm expects octal bits: " + term);
+            }
+            permBits = static_cast<uint32_t>(std::stoul(bits, nullptr, 8));
+        } else if (startsWith(term, "exclude:")) {
+            std::string pattern = term.substr(8);
+            if (pattern == "none") excludes.clear();
+            else excludes.push_back(pattern);
+        } else if (startsWith(term, "sort:")) {
+            std::string key = term.substr(5);
+            ascending = !key.empty() && key[0] == '+';
+            if (!key.empty() && (key[0] == '+' || key[0] == '-')) key.erase(0, 1);
+            if (key == "size") sortKey = SortKey::Size;
+            else if (key == "mtime") sortKey = SortKey::Mtime;
+            else throw std::invalid_argument("sort key must be size or mtime: " + term);
+        } else if (startsWith(term, "top:")) {
+            try {
+                limit = std::stoul(term.substr(4));
+            } catch (const std::exception&) {
+                throw std::invalid_argument("invalid top count: " + term);
+            }
+        } else {
+            namePattern = term;
+            nameMode = term.find_first_of("*?[") == std::string::npos ? MatchMode::Substring : MatchMode::Glob;
+        }
+    }
+};
+
+class SelectionSet {
+public:
+    bool add(std::string path) { return paths.insert(std::move(path)).second; }
+    bool remove(const std::string& path) { return paths.erase(path) > 0; }
+    void clear() { paths.clear(); }
+    size_t size() const { return paths.size(); }
+    bool empty() const { return paths.empty(); }
+    const std::set<std::string>& items() const { return paths; }
+
+    size_t addMatching(const fs::path& dir, const NameMatcher& matcher, bool recursive) {
+        std::mutex lock;
+        size_t added = 0;
+        ParallelWalker walker;
+        walker.walk(dir, [&](const WalkEntry& entry) {
+            if (matcher.matches(entry.name)) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (add(entry.path)) added++;
+            }
+            return recursive;
+        });
+        return added;
+    }
+
+    static std::vector<size_t> parseIndices(const std::string& text, size_t limit) {
+        std::vector<size_t> indices;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, ',')) {
+            part.erase(std::remove(part.begin(), part.end(), ' '), part.end());
+            if (part.empty()) continue;
+            size_t dash = part.find('-');
+            size_t first, last;
+            try {
+                first = std::stoul(part.substr(0, dash));
+                last = dash == std::string::npos ? first : std::stoul(part.substr(dash + 1));
+            } catch (const std::exception&) {
+                throw std::invalid_argument("invalid index: " + part);
+            }
+            if (first == 0 || last < first || last > limit) throw std::invalid_argument("index out of range: " + part);
+            for (size_t i = first; i <= last; i++) indices.push_back(i - 1);
+        }
+        return indices;
+    }
+
+private:
+    std::set<std::string> paths;
+};
+
+enum class BatchAction { Copy, Move, Delete, Chmod };
+
+struct BatchStep {
+    std::string source;
+    std::string target;
+    bool isDirectory = false;
+    int depth = 0;
+    std::string skipReason;
+};
+
+struct BatchResult {
+    std::atomic<uintmax_t> succeeded{0};
+    std::atomic<uintmax_t> skipped{0};
+    std::vector<std::string> failures;
+    double seconds = 0;
+};
+
+class BatchPlan {
+public:
+    static BatchPlan build(const SelectionSet& selection, BatchAction action, const fs::path& destination = {},
+                           const ModeSpec* mode = nullptr) {
+        BatchPlan plan;
+        plan.action = action;
+        plan.mode = mode;
+        bool needsTarget = action == BatchAction::Copy || action == BatchAction::Move;
+        if (needsTarget && !fs::is_directory(destination)) {
+            throw fs::filesystem_error("destination is not a directory", destination,
+                                       std::make_error_code(std::errc::not_a_directory));
+        }
+
+        std::set<std::string> targets;
+        for (const auto& path : selection.items()) {
+            if (action != BatchAction::Chmod && hasSelectedAncestor(selection, path)) {
+                plan.collapsed++;
+                continue;
+            }
+            BatchStep step;
+            step.source = path;
+            step.depth = static_cast<int>(std::count(path.begin(), path.end(), '/'));
+            struct stat st;
+            if (lstat(path.c_str(), &st) != 0) {
+                step.skipReason = std::strerror(errno);
+            } else {
+                step.isDirectory = S_ISDIR(st.st_mode);
+            }
+            if (needsTarget && step.skipReason.empty()) {
+                step.target = (destination / fs::path(path).filename()).string();
+                struct stat existing;
+                if (!targets.insert(step.target).second) {
+                    step.skipReason = "another selected entry has the same name";
+                } else if (lstat(step.target.c_str(), &existing) == 0) {
+                    step.skipReason = "target already exists";
+                } else if (step.isDirectory && isWithin(destination.string(), path)) {
+                    step.skipReason = "destination is inside the source";
+                }
+            }
+            plan.planned.push_back(std::move(step));
+        }
+
+        std::stable_sort(plan.planned.begin(), plan.planned.end(), [](const BatchStep& a, const BatchStep& b) {
+            return a.depth > b.depth;
+        });
+        return plan;
+    }
+
+    const std::vector<BatchStep>& steps() const { return planned; }
+    size_t collapsedCount() const { return collapsed; }
+
+    size_t runnableCount() const {
+        return static_cast<size_t>(std::count_if(planned.begin(), planned.end(),
+            [](const BatchStep& step) { return step.skipReason.empty(); }));
+    }
+
+    std::string describe(const BatchStep& step) const {
+        std::string line;
+        switch (action) {
+            case BatchAction::Copy: line = "copy   " + step.source + " -> " + step.target; break;
+            case BatchAction::Move: line = "move   " + step.source + " -> " + step.target; break;
+            case BatchAction::Delete: line = "delete " + step.source + (step.isDirectory ? "/ (tree)" : ""); break;
+            case BatchAction::Chmod: line = "chmod  " + mode->text() + " " + step.source; break;
+        }
+        if (!step.skipReason.empty()) line += "   [skip: " + step.skipReason + "]";
+        return line;
+    }
+
+    void execute(BatchResult& result) const {
+        ScopedTimer timer("batch.execute");
+        JobInterrupt interrupt;
+        auto start = std::chrono::steady_clock::now();
+        std::mutex lock;
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        TaskPool pool(std::max(2u, std::min(cores, 8u)), cores * 4);
+        auto perform = [this, &result, &lock](const BatchStep& step) {
+            if (JobInterrupt::requested()) {
+                result.skipped++;
+                return;
+            }
+            std::string error = run(step);
+            if (error.empty()) {
+                result.succeeded++;
+            } else {
+                std::lock_guard<std::mutex> guard(lock);
+                result.failures.push_back(step.source + ": " + error);
+            }
+        };
+        for (size_t first = 0; first < planned.size();) {
+            size_t last = first;
+            while (last < planned.size() && planned[last].depth == planned[first].depth) last++;
+            std::vector<const BatchStep*> trees;
+            for (size_t i = first; i < last; i++) {
+                const BatchStep& step = planned[i];
+                if (!step.skipReason.empty()) {
+                    result.skipped++;
+                } else if (step.isDirectory && action != BatchAction::Chmod) {
+                    trees.push_back(&step);
+                } else {
+                    pool.submit([&perform, &step] { perform(step); });
+                }
+            }
+            for (const BatchStep* step : trees) perform(*step);
+            pool.wait();
+            first = last;
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    BatchAction action = BatchAction::Delete;
+    const ModeSpec* mode = nullptr;
+    std::vector<BatchStep> planned;
+    size_t collapsed = 0;
+
+    static bool isWithin(const std::string& path, const std::string& ancestor) {
+        return path == ancestor ||
+               (path.size() > ancestor.size() && path.compare(0, ancestor.size(), ancestor) == 0 &&
+                (ancestor.back() == '/' || path[ancestor.size()] == '/'));
+    }
+
+    static bool hasSelectedAncestor(const SelectionSet& selection, const std::string& path) {
+        for (fs::path parent = fs::path(path).parent_path(); !parent.empty(); parent = parent.parent_path()) {
+            if (selection.items().count(parent.string())) return true;
+            if (parent == parent.parent_path()) break;
+        }
+        return false;
+    }
+
+    std::string run(const BatchStep& step) const {
+        try {
+            switch (action) {
+                case BatchAction::Copy: {
+                    if (step.isDirectory) {
+                        TreeCopyStats stats;
+                        JobRunner::copy(step.source, step.target, stats);
+                        if (!stats.errors.empty()) return stats.errors.front();
+                        if (stats.interrupted) return "interrupted";
+                    } else {
+                        CopyEngine::copyFileAtomic(step.source, step.target);
+                    }
+                    return "";
+                }
+                case BatchAction::Move: {
+                    TreeCopyStats stats;
+                    JobRunner::move(step.source, step.target, stats);
+                    if (!stats.errors.empty()) return stats.errors.front();
+                    if (stats.interrupted) return "interrupted";
+                    return "";
+                }
+                case BatchAction::Delete: {
+                    if (step.isDirectory) {
+                        DeleteStats stats;
+                        JobRunner::remove(step.source, stats);
+                        if (!stats.failures.empty()) return stats.failures.front();
+                        if (stats.interrupted) return "interrupted";
+                    } else if (unlink(step.source.c_str()) != 0) {
+                        return std::strerror(errno);
+                    }
+                    return "";
+                }
+                case BatchAction::Chmod: {
+                    struct stat st;
+                    if (stat(step.source.c_str(), &st) != 0) return std::strerror(errno);
+                    mode_t target = mode->apply(st.st_mode, S_ISDIR(st.st_mode));
+                    if (target != (st.st_mode & 07777) && fchmodat(AT_FDCWD, step.source.c_str(), target, 0) != 0) {
+                        return std::strerror(errno);
+                    }
+                    return "";
+                }
+            }
+        } catch (const fs::filesystem_error& e) {
+            return e.code().message();
+        }
+        return "";
+    }
+};
+
+struct SnapshotEntry {
+    std::string path;
+    unsigned char type = DT_UNKNOWN;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t inode = 0;
+    uint32_t mode = 0;
+    uint64_t hash = 0;
+};
+
+inline bool snapshotPathLess(std::string_view a, std::string_view b) {
+    size_t common = std::min(a.size(), b.size());
+    for (size_t i = 0; i < common; i++) {
+        unsigned char left = a[i] == '/' ? 0 : static_cast<unsigned char>(a[i]);
+        unsigned char right = b[i] == '/' ? 0 : static_cast<unsigned char>(b[i]);
+        if (left != right) return left < right;
+    }
+    return a.size() < b.size();
+}
+
+class SnapshotFile {
+public:
+    static constexpr char magic[8] = {'F', 'X', 'S', 'N', 'A', 'P', '0', '1'};
+    static constexpr unsigned char endMarker = 0xFF;
+
+    static void save(const fs::path& file, const std::string& root, const std::vector<SnapshotEntry>& entries,
+                     bool hashes) {
+        std::error_code ec;
+        fs::create_directories(file.parent_path(), ec);
+        fs::path temp = file;
+        temp += ".tmp";
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) fail("cannot create snapshot", temp);
+        std::string buffer(magic, sizeof(magic));
+        putVarint(buffer, hashes ? 1 : 0);
+        putVarint(buffer, static_cast<uint64_t>(std::time(nullptr)));
+        putVarint(buffer, root.size());
+        buffer += root;
+
+        std::string_view previous;
+        for (const auto& entry : entries) {
+            size_t shared = 0;
+            size_t limit = std::min(previous.size(), entry.path.size());
+            while (shared < limit && previous[shared] == entry.path[shared]) shared++;
+            buffer += static_cast<char>(entry.type == endMarker ? static_cast<unsigned char>(DT_UNKNOWN) : entry.type);
+            putVarint(buffer, shared);
+            putVarint(buffer, entry.path.size() - shared);
+            buffer.append(entry.path, shared, std::string::npos);
+            putVarint(buffer, entry.size);
+            putVarint(buffer, static_cast<uint64_t>(entry.mtime));
+            putVarint(buffer, entry.inode);
+            putVarint(buffer, entry.mode);
+            if (hashes) buffer.append(reinterpret_cast<const char*>(&entry.hash), sizeof(entry.hash));
+            previous = entry.path;
+            if (buffer.size() >= 1024 * 1024) {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+        buffer += static_cast<char>(endMarker);
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        out.close();
+        if (!out) fail("cannot write snapshot", temp);
+        fs::rename(temp, file);
+    }
+
+    class Reader {
+    public:
+        explicit Reader(const fs::path& file) : file(file), in(file, std::ios::binary) {
+            char header[sizeof(magic)];
+            if (!in.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0) {
+                fail("not a snapshot file", file);
+            }
+            uint64_t flags = getVarint();
+            hashes = (flags & 1) != 0;
+            created = static_cast<time_t>(getVarint());
+            rootPath.resize(static_cast<size_t>(getVarint()));
+            if (!in.read(rootPath.data(), static_cast<std::streamsize>(rootPath.size()))) fail("truncated snapshot", file);
+        }
+
+        const std::string& root() const { return rootPath; }
+        bool hasHashes() const { return hashes; }
+        time_t createdAt() const { return created; }
+
+        bool next(SnapshotEntry& entry) {
+            int type = in.get();
+            if (type == EOF) fail("truncated snapshot", file);
+            if (type == endMarker) return false;
+            size_t shared = static_cast<size_t>(getVarint());
+            size_t suffix = static_cast<size_t>(getVarint());
+            if (shared > previous.size()) fail("corrupt snapshot", file);
+            previous.resize(shared + suffix);
+            if (!in.read(previous.data() + shared, static_cast<std::streamsize>(suffix))) fail("truncated snapshot", file);
+            entry.path = previous;
+            entry.type = static_cast<unsigned char>(type);
+            entry.size = getVarint();
+            entry.mtime = static_cast<int64_t>(getVarint());
+            entry.inode = getVarint();
+            entry.mode = static_cast<uint32_t>(getVarint());
+            entry.hash = 0;
+            if (hashes && !in.read(reinterpret_cast<char*>(&entry.hash), sizeof(entry.hash))) {
+                fail("truncated snapshot", file);
+            }
+            return true;
+        }
+
+    private:
+        fs::path file;
+        std::ifstream in;
+        std::string rootPath;
+        std::string previous;
+        bool hashes = false;
+        time_t created = 0;
+
+        uint64_t getVarint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                int byte = in.get();
+                if (byte == EOF) fail("truncated snapshot", file);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            fail("corrupt snapshot", file);
+            return 0;
+        }
+    };
+
+    static std::vector<SnapshotEntry> load(const fs::path& file, std::string& root, bool& hashes) {
+        Reader reader(file);
+        root = reader.root();
+        hashes = reader.hasHashes();
+        std::vector<SnapshotEntry> entries;
+        SnapshotEntry entry;
+        while (reader.next(entry)) entries.push_back(entry);
+        return entries;
+    }
+
+    static fs::path defaultLocation(const fs::path& root) {
+        const char* cacheHome = getenv("XDG_CACHE_HOME");
+        const char* home = getenv("HOME");
+        fs::path base = cacheHome ? fs::path(cacheHome) : fs::path(home ? home : "/tmp") / ".cache";
+        char name[48];
+        snprintf(name, sizeof(name), "snapshot-%016zx.snap", std::hash<std::string>{}(root.string()));
+        return base / "file_explorer" / name;
+    }
+
+private:
+    [[noreturn]] static void fail(const char* what, const fs::path& file) {
+        throw fs::filesystem_error(what, file, std::make_error_code(std::errc::invalid_argument));
+    }
+
+    static void putVarint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out += static_cast<char>(value);
+    }
+};
+
+struct CaptureStats {
+    uintmax_t entries = 0;
+    uintmax_t directoriesRead = 0;
+    uintmax_t directoriesReused = 0;
+    std::atomic<uintmax_t> filesHashed{0};
+    uintmax_t errors = 0;
+    double seconds = 0;
+};
+
+class TreeSnapshot {
+public:
+    static std::vector<SnapshotEntry> capture(const fs::path& root, const std::vector<SnapshotEntry>* previous,
+                                              bool hashes, CaptureStats& stats) {
+        ScopedTimer timer("snapshot.capture");
+        auto start = std::chrono::steady_clock::now();
+        std::vector<SnapshotEntry> entries;
+        int fd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            throw fs::filesystem_error("cannot open directory", root, std::error_code(errno, std::generic_category()));
+        }
+        struct stat rootStat;
+        fstat(fd, &rootStat);
+        const SnapshotEntry* oldRoot = previous ? findEntry(previous, "") : nullptr;
+        bool rootUnchanged = oldRoot && oldRoot->type == DT_DIR && oldRoot->mtime == mtimeOf(rootStat) &&
+                             oldRoot->inode == static_cast<uint64_t>(rootStat.st_ino);
+        captureDirectory(fd, "", previous, rootUnchanged, entries, stats);
+        close(fd);
+        entries.insert(entries.begin(), SnapshotEntry{"", DT_DIR, 0, mtimeOf(rootStat),
+                                                      static_cast<uint64_t>(rootStat.st_ino),
+                                                      static_cast<uint32_t>(rootStat.st_mode & 07777), 0});
+        if (hashes) hashContents(root, entries, previous, stats);
+        stats.entries = entries.size();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return entries;
+    }
+
+private:
+    static int64_t mtimeOf(const struct stat& st) {
+        return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+
+    static const SnapshotEntry* findEntry(const std::vector<SnapshotEntry>* previous, const std::string& path) {
+        if (!previous) return nullptr;
+        auto it = std::lower_bound(previous->begin(), previous->end(), path,
+            [](const SnapshotEntry& entry, const std::string& key) { return snapshotPathLess(entry.path, key); });
+        return it != previous->end() && it->path == path ? &*it : nullptr;
+    }
+
+    static std::vector<std::string> previousChildren(const std::vector<SnapshotEntry>& previous,
+                                                     const std::string& dir) {
+        std::vector<std::string> names;
+        std::string prefix = dir.empty() ? "" : dir + "/";
+        auto it = std::upper_bound(previous.begin(), previous.end(), dir,
+            [](const std::string& key, const SnapshotEntry& entry) { return snapshotPathLess(key, entry.path); });
+        for (; it != previous.end() && it->path.compare(0, prefix.size(), prefix) == 0; ++it) {
+            if (it->path.find('/', prefix.size()) == std::string::npos) names.push_back(it->path.substr(prefix.size()));
+        }
+        return names;
+    }
+
+    static void captureDirectory(int fd, const std::string& dir, const std::vector<SnapshotEntry>* previous,
+                                 bool unchanged, std::vector<SnapshotEntry>& entries, CaptureStats& stats) {
+        std::vector<std::string> names;
+        if (unchanged) {
+            names = previousChildren(*previous, dir);
+            stats.directoriesReused++;
+        } else {
+            std::vector<char> buffer(64 * 1024);
+            long bytes;
+            while ((bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size())) > 0) {
+                Instrumentation::add(Counter::Syscalls);
+                for (long offset = 0; offset < bytes;) {
+                    auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+                    offset += dirent->d_reclen;
+                    const char* name = dirent->d_name;
+                    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+                    names.emplace_back(name);
+                }
+            }
+            if (bytes < 0) stats.errors++;
+            stats.directoriesRead++;
+        }
+        std::sort(names.begin(), names.end());
+
+        for (const auto& name : names) {
+            struct stat st;
+            Instrumentation::add(Counter::Syscalls);
+            if (fstatat(fd, name.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                if (!unchanged) stats.errors++;
+                continue;
+            }
+            std::string path = dir.empty() ? name : dir + "/" + name;
+            SnapshotEntry entry{path, static_cast<unsigned char>(IFTODT(st.st_mode)),
+                                S_ISDIR(st.st_mode) ? 0 : static_cast<uint64_t>(st.st_size), mtimeOf(st),
+                                static_cast<uint64_t>(st.st_ino), static_cast<uint32_t>(st.st_mode & 07777), 0};
+            entries.push_back(entry);
+            if (!S_ISDIR(st.st_mode)) continue;
+
+            int child = openat(fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (child < 0) {
+                stats.errors++;
+                continue;
+            }
+            const SnapshotEntry* old = findEntry(previous, path);
+            bool childUnchanged = old && old->type == DT_DIR && old->mtime == entry.mtime && old->inode == entry.inode;
+            captureDirectory(child, path, previous, childUnchanged, entries, stats);
+            close(child);
+        }
+    }
+
+    static void hashContents(const fs::path& root, std::vector<SnapshotEntry>& entries,
+                             const std::vector<SnapshotEntry>* previous, CaptureStats& stats) {
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        TaskPool pool(std::max(2u, cores), cores * 8);
+        std::string prefix = root.string();
+        if (prefix.empty() || prefix.back() != '/') prefix += '/';
+        for (auto& entry : entries) {
+            if (entry.type != DT_REG) continue;
+            const SnapshotEntry* old = findEntry(previous, entry.path);
+            if (old && old->hash != 0 && old->size == entry.size && old->mtime == entry.mtime &&
+                old->inode == entry.inode) {
+                entry.hash = old->hash;
+                continue;
+            }
+            pool.submit([&entry, &stats, prefix] {
+                if (FastHash::hashFile(prefix + entry.path, entry.size, entry.hash)) stats.filesHashed++;
+            });
+        }
+        pool.wait();
+    }
+};
+
+enum class ChangeKind { Added, Removed, Modified, Renamed };
+
+struct TreeChange {
+    ChangeKind kind;
+    std::string path;
+    std::string from;
+    unsigned char type;
+    std::string detail;
+};
+
+struct DiffStats {
+    uintmax_t added = 0;
+    uintmax_t removed = 0;
+    uintmax_t modified = 0;
+    uintmax_t renamed = 0;
+    uintmax_t compared = 0;
+};
+
+class TreeDiff {
+public:
+    using Source = std::function<bool(SnapshotEntry&)>;
+
+    static Source fromVector(const std::vector<SnapshotEntry>& entries) {
+        auto position = std::make_shared<size_t>(0);
+        return [&entries, position](SnapshotEntry& out) {
+            if (*position >= entries.size()) return false;
+            out = entries[(*position)++];
+            return true;
+        };
+    }
+
+    static std::vector<TreeChange> diff(const Source& before, const Source& after, DiffStats& stats) {
+        ScopedTimer timer("snapshot.diff");
+        std::vector<TreeChange> changes;
+        std::vector<SnapshotEntry> removed;
+        std::vector<SnapshotEntry> added;
+        SnapshotEntry left, right;
+        bool haveLeft = before(left);
+        bool haveRight = after(right);
+        while (haveLeft || haveRight) {
+            stats.compared++;
+            if (haveLeft && (!haveRight || snapshotPathLess(left.path, right.path))) {
+                removed.push_back(left);
+                haveLeft = before(left);
+            } else if (haveRight && (!haveLeft || snapshotPathLess(right.path, left.path))) {
+                added.push_back(right);
+                haveRight = after(right);
+            } else {
+                std::string detail = describeChange(left, right);
+                if (!detail.empty()) changes.push_back(TreeChange{ChangeKind::Modified, right.path, "", right.type, detail});
+                haveLeft = before(left);
+                haveRight = after(right);
+            }
+        }
+
+        std::vector<TreeChange> renames = pairRenames(removed, added);
+        for (const auto& entry : removed) {
+            if (!entry.path.empty()) changes.push_back(TreeChange{ChangeKind::Removed, entry.path, "", entry.type, ""});
+        }
+        for (const auto& entry : added) {
+            if (!entry.path.empty()) changes.push_back(TreeChange{ChangeKind::Added, entry.path, "", entry.type, ""});
+        }
+        changes.insert(changes.end(), renames.begin(), renames.end());
+        std::sort(changes.begin(), changes.end(), [](const TreeChange& a, const TreeChange& b) {
+            return snapshotPathLess(a.path, b.path);
+        });
+        for (const auto& change : changes) {
+            switch (change.kind) {
+                case ChangeKind::Added: stats.added++; break;
+                case ChangeKind::Removed: stats.removed++; break;
+                case ChangeKind::Modified: stats.modified++; break;
+                case ChangeKind::Renamed: stats.renamed++; break;
+            }
+        }
+        return changes;
+    }
+
+    static char marker(ChangeKind kind) {
+        switch (kind) {
+            case ChangeKind::Added: return '+';
+            case ChangeKind::Removed: return '-';
+            case ChangeKind::Modified: return 'M';
+            case ChangeKind::Renamed: return 'R';
+        }
+        return '?';
+    }
+
+private:
+    static std::string describeChange(const SnapshotEntry& before, const SnapshotEntry& after) {
+        std::string detail;
+        auto note = [&](const std::string& text) {
+            if (!detail.empty()) detail += ", ";
+            detail += text;
+        };
+        if (before.type != after.type) {
+            note("type changed");
+            return detail;
+        }
+        if (before.mode != after.mode) {
+            char text[32];
+            snprintf(text, sizeof(text), "mode %04o -> %04o", before.mode, after.mode);
+            note(text);
+        }
+        if (after.type == DT_DIR) return detail;
+        if (before.size != after.size) {
+            note("size " + std::to_string(before.size) + " -> " + std::to_string(after.size));
+        }
+        if (before.hash != 0 && after.hash != 0) {
+            if (before.hash != after.hash && before.size == after.size) note("content");
+        } else if (before.mtime != after.mtime && before.size == after.size) {
+            note("mtime");
+        }
+        if (before.inode != after.inode && detail.empty()) note("replaced");
+        return detail;
+    }
+
+    static std::vector<TreeChange> pairRenames(std::vector<SnapshotEntry>& removed, std::vector<SnapshotEntry>& added) {
+        std::unordered_map<uint64_t, size_t> removedByInode;
+        for (size_t i = 0; i < removed.size(); i++) {
+            if (removed[i].inode != 0) removedByInode.emplace(removed[i].inode, i);
+        }
+        std::vector<TreeChange> renames;
+        std::vector<bool> removedPaired(removed.size(), false);
+        std::vector<bool> addedPaired(added.size(), false);
+        std::vector<std::pair<std::string, std::string>> renamedDirectories;
+        for (size_t i = 0; i < added.size(); i++) {
+            auto it = removedByInode.find(added[i].inode);
+            if (it == removedByInode.end()) continue;
+            const SnapshotEntry& old = removed[it->second];
+            if (removedPaired[it->second] || old.type != added[i].type ||
+                (old.type != DT_DIR && old.size != added[i].size)) {
+                continue;
+            }
+            removedPaired[it->second] = true;
+            addedPaired[i] = true;
+            if (impliedByParent(renamedDirectories, old.path, added[i].path)) {
+                std::string detail = describeChange(old, added[i]);
+                if (!detail.empty()) {
+                    renames.push_back(TreeChange{ChangeKind::Modified, added[i].path, "", added[i].type, detail});
+                }
+                continue;
+            }
+            if (old.type == DT_DIR) renamedDirectories.emplace_back(old.path + "/", added[i].path + "/");
+            renames.push_back(TreeChange{ChangeKind::Renamed, added[i].path, old.path, old.type, ""});
+        }
+        compact(removed, removedPaired);
+        compact(added, addedPaired);
+        return renames;
+    }
+
+    static bool impliedByParent(const std::vector<std::pair<std::string, std::string>>& renamedDirectories,
+                                const std::string& from, const std::string& to) {
+        for (const auto& [oldPrefix, newPrefix] : renamedDirectories) {
+            if (from.compare(0, oldPrefix.size(), oldPrefix) == 0 && to.compare(0, newPrefix.size(), newPrefix) == 0 &&
+                from.compare(oldPrefix.size(), std::string::npos, to, newPrefix.size(), std::string::npos) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void compact(std::vector<SnapshotEntry>& entries, const std::vector<bool>& paired) {
+        size_t kept = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (paired[i]) continue;
+            if (kept != i) entries[kept] = std::move(entries[i]);
+            kept++;
+        }
+        entries.resize(kept);
+    }
+};
+
+struct ArchiveStats {
+    std::atomic<uintmax_t> files{0};
+    std::atomic<uintmax_t> directories{0};
+    std::atomic<uintmax_t> symlinks{0};
+    std::atomic<uintmax_t> bytes{0};
+    uintmax_t archiveBytes = 0;
+    uintmax_t skipped = 0;
+    std::vector<std::string> errors;
+    std::mutex errorLock;
+    double seconds = 0;
+
+    void recordError(const std::string& path, int error) {
+        std::lock_guard<std::mutex> guard(errorLock);
+        errors.push_back(path + ": " + std::strerror(error));
+    }
+
+    double megabytesPerSecond() const {
+        return seconds > 0 ? bytes / seconds / (1024.0 * 1024.0) : 0.0;
+    }
+};
+
+class ArchiveOutput {
+public:
+    static constexpr size_t blockBytes = 1024 * 1024;
+
+    ArchiveOutput(int fd, bool compress, int level = Z_DEFAULT_COMPRESSION) : fd(fd), compress(compress), level(level) {
+        block.reserve(blockBytes);
+        if (compress) {
+            unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+            maxPending = cores * 2;
+            pool = std::make_unique<TaskPool>(cores, cores * 2);
+        }
+    }
+
+    void write(std::string_view data) {
+        accepted += data.size();
+        while (!data.empty()) {
+            size_t take = std::min(data.size(), blockBytes - block.size());
+            block.append(data.data(), take);
+            data.remove_prefix(take);
+            if (block.size() == blockBytes) flushBlock();
+        }
+    }
+
+    void finish() {
+        if (!block.empty() || (compress && written == 0 && pending.empty())) flushBlock();
+        while (!pending.empty()) drainOne();
+    }
+
+    uintmax_t bytesAccepted() const { return accepted; }
+    uintmax_t bytesWritten() const { return written; }
+
+private:
+    int fd;
+    bool compress;
+    int level;
+    std::string block;
+    std::unique_ptr<TaskPool> pool;
+    std::deque<std::future<std::string>> pending;
+    size_t maxPending = 0;
+    uintmax_t accepted = 0;
+    uintmax_t written = 0;
+
+    void flushBlock() {
+        if (!compress) {
+            writeAll(block);
+            block.clear();
+            return;
+        }
+        auto input = std::make_shared<std::string>(std::move(block));
+        block = std::string();
+        block.reserve(blockBytes);
+        auto result = std::make_shared<std::promise<std::string>>();
+        pending.push_back(result->get_future());
+        int compressionLevel = level;
+        pool->submit([input, result, compressionLevel] { result->set_value(gzipMember(*input, compressionLevel)); });
+        while (pending.size() > maxPending) drainOne();
+    }
+
+    void drainOne() {
+        std::string member = pending.front().get();
+        pending.pop_front();
+        writeAll(member);
+    }
+
+    static std::string gzipMember(const std::string& input, int level) {
+        ScopedTimer timer("archive.deflate");
+        z_stream stream{};
+        deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        std::string output(deflateBound(&stream, input.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+        deflate(&stream, Z_FINISH);
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+        return output;
+    }
+
+    void writeAll(std::string_view data) {
+        while (!data.empty()) {
+            ssize_t bytes = ::write(fd, data.data(), data.size());
+            if (bytes < 0) {
+                if (errno == EINTR) continue;
+                throw fs::filesystem_error("cannot write archive", std::error_code(errno, std::generic_category()));
+            }
+            Instrumentation::add(Counter::Syscalls);
+            data.remove_prefix(static_cast<size_t>(bytes));
+            written += static_cast<uintmax_t>(bytes);
+        }
+    }
+};
+
+class ArchiveInput {
+public:
+    static constexpr size_t chunkBytes = 1024 * 1024;
+    static constexpr size_t queueDepth = 8;
+
+    explicit ArchiveInput(int fd) : fd(fd) {
+        producer = std::thread([this] { produce(); });
+    }
+
+    ArchiveInput(const ArchiveInput&) = delete;
+    ArchiveInput& operator=(const ArchiveInput&) = delete;
+
+    ~ArchiveInput() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            cancelled = true;
+        }
+        spaceAvailable.notify_all();
+        producer.join();
+    }
+
+    bool read(char* out, size_t size) {
+        while (size > 0) {
+            if (offset == current.size() && !nextChunk()) return false;
+            size_t take = std::min(size, current.size() - offset);
+            std::memcpy(out, current.data() + offset, take);
+            offset += take;
+            out += take;
+            size -= take;
+        }
+        return true;
+    }
+
+    bool skip(uintmax_t size) {
+        while (size > 0) {
+            if (offset == current.size() && !nextChunk()) return false;
+            size_t take = static_cast<size_t>(std::min<uintmax_t>(size, current.size() - offset));
+            offset += take;
+            size -= take;
+        }
+        return true;
+    }
+
+    bool compressed() const { return gzip; }
+    uintmax_t bytesRead() const { return consumed; }
+
+private:
+    int fd;
+    std::thread producer;
+    std::deque<std::string> chunks;
+    std::mutex lock;
+    std::condition_variable chunkReady;
+    std::condition_variable spaceAvailable;
+    bool finished = false;
+    bool cancelled = false;
+    int error = 0;
+    std::atomic<bool> gzip{false};
+    std::atomic<uintmax_t> consumed{0};
+    std::string current;
+    size_t offset = 0;
+
+    bool nextChunk() {
+        std::unique_lock<std::mutex> guard(lock);
+        chunkReady.wait(guard, [this] { return finished || !chunks.empty(); });
+        if (chunks.empty()) {
+            if (error != 0) {
+                throw fs::filesystem_error("cannot read archive", std::error_code(error, std::generic_category()));
+            }
+            return false;
+        }
+        current = std::move(chunks.front());
+        chunks.pop_front();
+        offset = 0;
+        guard.unlock();
+        spaceAvailable.notify_one();
+        return true;
+    }
+
+    bool push(std::string chunk) {
+        std::unique_lock<std::mutex> guard(lock);
+        spaceAvailable.wait(guard, [this] { return cancelled || chunks.size() < queueDepth; });
+        if (cancelled) return false;
+        chunks.push_back(std::move(chunk));
+        guard.unlock();
+        chunkReady.notify_one();
+        return true;
+    }
+
+    void finish(int failure) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            finished = true;
+            error = failure;
+        }
+        chunkReady.notify_all();
+    }
+
+    ssize_t readRaw(char* buffer, size_t size) {
+        ssize_t bytes;
+        do {
+            bytes = ::read(fd, buffer, size);
+        } while (bytes < 0 && errno == EINTR);
+        if (bytes > 0) consumed += static_cast<uintmax_t>(bytes);
+        return bytes;
+    }
+
+    void produce() {
+        std::string raw(chunkBytes, '\0');
+        ssize_t bytes = readRaw(raw.data(), raw.size());
+        if (bytes < 0) return finish(errno);
+        raw.resize(static_cast<size_t>(bytes));
+        gzip = raw.size() >= 2 && static_cast<unsigned char>(raw[0]) == 0x1f &&
+               static_cast<unsigned char>(raw[1]) == 0x8b;
+        if (!gzip) {
+            while (!raw.empty()) {
+                if (!push(std::move(raw))) return finish(0);
+                raw.assign(chunkBytes, '\0');
+                bytes = readRaw(raw.data(), raw.size());
+                if (bytes < 0) return finish(errno);
+                raw.resize(static_cast<size_t>(bytes));
+            }
+            return finish(0);
+        }
+
+        z_stream stream{};
+        inflateInit2(&stream, 15 + 32);
+        stream.next_in = reinterpret_cast<Bytef*>(raw.data());
+        stream.avail_in = static_cast<uInt>(raw.size());
+        std::string output(chunkBytes, '\0');
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+        int failure = 0;
+        bool more = true;
+        while (more) {
+            if (stream.avail_in == 0) {
+                raw.resize(chunkBytes);
+                bytes = readRaw(raw.data(), raw.size());
+                if (bytes < 0) {
+                    failure = errno;
+                    break;
+                }
+                if (bytes == 0) {
+                    failure = stream.total_in > 0 ? EILSEQ : 0;
+                    break;
+                }
+                stream.next_in = reinterpret_cast<Bytef*>(raw.data());
+                stream.avail_in = static_cast<uInt>(bytes);
+            }
+            int status;
+            {
+                ScopedTimer timer("archive.inflate");
+                status = inflate(&stream, Z_NO_FLUSH);
+            }
+            if (status == Z_STREAM_END) {
+                inflateReset(&stream);
+                if (stream.avail_in == 0) {
+                    bytes = readRaw(raw.data(), chunkBytes);
+                    if (bytes <= 0) more = false;
+                    stream.next_in = reinterpret_cast<Bytef*>(raw.data());
+                    stream.avail_in = static_cast<uInt>(std::max<ssize_t>(bytes, 0));
+                }
+                if (more && (stream.avail_in < 2 || stream.next_in[0] != 0x1f || stream.next_in[1] != 0x8b)) more = false;
+            } else if (status != Z_OK && status != Z_BUF_ERROR) {
+                failure = EILSEQ;
+                break;
+            }
+            if (stream.avail_out == 0 || (!more && stream.avail_out < output.size())) {
+                output.resize(output.size() - stream.avail_out);
+                if (!push(std::move(output))) break;
+                output.assign(chunkBytes, '\0');
+                stream.next_out = reinterpret_cast<Bytef*>(output.data());
+                stream.avail_out = static_cast<uInt>(output.size());
+            }
+        }
+        inflateEnd(&stream);
+        finish(failure);
+    }
+};
+
+class TarArchive {
+public:
+    static constexpr size_t blockSize = 512;
+    static constexpr uintmax_t readAheadBytes = 64 * 1024 * 1024;
+    static constexpr uintmax_t bufferedFileLimit = 8 * 1024 * 1024;
+    static constexpr uintmax_t extractBufferLimit = 1024 * 1024;
+    static constexpr size_t windowEntries = 4096;
+
+    static bool wantsCompression(const fs::path& file) {
+        std::string name = file.filename().string();
+        auto endsWith = [&](const char* suffix) {
+            size_t length = strlen(suffix);
+            return name.size() >= length && name.compare(name.size() - length, length, suffix) == 0;
+        };
+        return endsWith(".gz") || endsWith(".tgz");
+    }
+
+    static void create(const fs::path& root, int fd, bool compress, ArchiveStats& stats) {
+        ScopedTimer timer("archive.create");
+        auto start = std::chrono::steady_clock::now();
+        fs::path base = fs::absolute(root).lexically_normal();
+        if (!base.has_filename()) base = base.parent_path();
+        std::string top = base.filename().string();
+        if (top.empty()) top = ".";
+
+        std::string prefix = base.string();
+        if (prefix.back() != '/') prefix += '/';
+        TreeStream stream(base, prefix, stats);
+
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        TaskPool readers(std::max(2u, cores), cores * 4);
+        std::deque<Pending> window;
+        uintmax_t aheadBytes = 0;
+        size_t scheduled = 0;
+        bool more = true;
+        auto schedule = [&] {
+            while (more && window.size() < windowEntries) {
+                Pending item;
+                if (!stream.next(item.entry)) {
+                    more = false;
+                    break;
+                }
+                window.push_back(std::move(item));
+            }
+            for (; scheduled < window.size(); scheduled++) {
+                Pending& item = window[scheduled];
+                uintmax_t size = static_cast<uintmax_t>(item.entry.st.st_size);
+                if (!S_ISREG(item.entry.st.st_mode) || size > bufferedFileLimit) continue;
+                if (aheadBytes + size > readAheadBytes && aheadBytes > 0) break;
+                auto result = std::make_shared<std::promise<FileData>>();
+                item.data = result->get_future();
+                aheadBytes += size;
+                std::string path = prefix + item.entry.path;
+                readers.submit([result, path] { result->set_value(readWhole(path)); });
+            }
+        };
+
+        ArchiveOutput output(fd, compress);
+        while (true) {
+            schedule();
+            if (window.empty()) break;
+            Pending item = std::move(window.front());
+            window.pop_front();
+            if (scheduled > 0) scheduled--;
+            const struct stat& st = item.entry.st;
+            std::string name = item.entry.path.empty() ? top : top + "/" + item.entry.path;
+            std::string path = prefix + item.entry.path;
+
+            if (item.data.valid()) {
+                FileData data = item.data.get();
+                aheadBytes -= static_cast<uintmax_t>(st.st_size);
+                if (data.error != 0) {
+                    stats.recordError(path, data.error);
+                    continue;
+                }
+                writeHeader(output, name, '0', data.st, data.content.size(), "");
+                output.write(data.content);
+                pad(output, data.content.size());
+                stats.files++;
+                stats.bytes += data.content.size();
+                continue;
+            }
+
+            if (S_ISDIR(st.st_mode)) {
+                writeHeader(output, name + "/", '5', st, 0, "");
+                stats.directories++;
+            } else if (S_ISLNK(st.st_mode)) {
+                std::string target(PATH_MAX, '\0');
+                ssize_t length = readlink(path.c_str(), target.data(), target.size());
+                if (length < 0) {
+                    stats.recordError(path, errno);
+                    continue;
+                }
+                target.resize(static_cast<size_t>(length));
+                writeHeader(output, name, '2', st, 0, target);
+                stats.symlinks++;
+            } else if (S_ISREG(st.st_mode)) {
+                streamFile(output, name, path, stats);
+            } else {
+                stats.skipped++;
+            }
+        }
+        output.write(std::string(blockSize * 2, '\0'));
+        uintmax_t total = output.bytesAccepted();
+        constexpr uintmax_t record = blockSize * 20;
+        if (!compress && total % record != 0) output.write(std::string(record - total % record, '\0'));
+        output.finish();
+        stats.archiveBytes = output.bytesWritten();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static void extract(int fd, const fs::path& destination, ArchiveStats& stats) {
+        ScopedTimer timer("archive.extract");
+        auto start = std::chrono::steady_clock::now();
+        fs::create_directories(destination);
+        ArchiveInput input(fd);
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        TaskPool writers(std::max(2u, cores), cores * 4);
+        std::set<std::string> createdDirectories;
+        std::vector<std::pair<std::string, Header>> directories;
+        std::vector<std::pair<std::string, Header>> links;
+        std::vector<char> buffer(ArchiveInput::chunkBytes);
+
+        Header header;
+        PaxOverrides pending;
+        while (readHeader(input, header)) {
+            if (header.type == 'x' || header.type == 'g' || header.type == 'L' || header.type == 'K') {
+                std::string payload(static_cast<size_t>(header.size), '\0');
+                if (!input.read(payload.data(), payload.size()) || !input.skip(padding(header.size))) truncated();
+                if (header.type == 'x') applyPax(payload, pending);
+                if (header.type == 'L') pending.path = payload.c_str();
+                if (header.type == 'K') pending.link = payload.c_str();
+                continue;
+            }
+            mergePending(header, pending);
+            std::string relative = safeRelative(header.path);
+            if (relative.empty()) {
+                stats.skipped++;
+                if (!input.skip(header.size + padding(header.size))) truncated();
+                continue;
+            }
+            fs::path target = destination / relative;
+            ensureParent(target, destination, createdDirectories);
+
+            if (header.type == '5') {
+                if (createdDirectories.insert(target.string()).second && mkdir(target.c_str(), 0700) != 0 &&
+                    errno != EEXIST) {
+                    stats.recordError(target.string(), errno);
+                }
+                directories.emplace_back(target.string(), header);
+                stats.directories++;
+                if (!input.skip(header.size + padding(header.size))) truncated();
+            } else if (header.type == '2' || header.type == '1') {
+                if (header.type == '1') {
+                    std::string linked = safeRelative(header.link);
+                    if (linked.empty()) {
+                        stats.skipped++;
+                        if (!input.skip(header.size + padding(header.size))) truncated();
+                        continue;
+                    }
+                    header.link = (destination / linked).string();
+                }
+                links.emplace_back(target.string(), header);
+                if (!input.skip(header.size + padding(header.size))) truncated();
+            } else if (header.type == '0' || header.type == '\0' || header.type == '7') {
+                if (header.size <= extractBufferLimit) {
+                    auto content = std::make_shared<std::string>(static_cast<size_t>(header.size), '\0');
+                    if (!input.read(content->data(), content->size()) || !input.skip(padding(header.size))) truncated();
+                    std::string path = target.string();
+                    writers.submit([content, path, header, &stats] {
+                        int out = createFile(path, header.mode);
+                        if (out < 0) return stats.recordError(path, errno);
+                        if (!writeFully(out, content->data(), content->size())) stats.recordError(path, errno);
+                        finishFile(out, header);
+                        stats.files++;
+                        stats.bytes += content->size();
+                    });
+                } else {
+                    int out = createFile(target.string(), header.mode);
+                    if (out < 0) stats.recordError(target.string(), errno);
+                    for (uintmax_t left = header.size; left > 0;) {
+                        size_t take = static_cast<size_t>(std::min<uintmax_t>(left, buffer.size()));
+                        if (!input.read(buffer.data(), take)) truncated();
+                        if (out >= 0 && !writeFully(out, buffer.data(), take)) {
+                            stats.recordError(target.string(), errno);
+                            close(out);
+                            out = -1;
+                        }
+                        left -= take;
+                    }
+                    if (!input.skip(padding(header.size))) truncated();
+                    if (out >= 0) {
+                        finishFile(out, header);
+                        stats.files++;
+                        stats.bytes += header.size;
+                    }
+                }
+            } else {
+                stats.skipped++;
+                if (!input.skip(header.size + padding(header.size))) truncated();
+            }
+        }
+        writers.wait();
+
+        for (const auto& [path, link] : links) {
+            unlink(path.c_str());
+            int result = link.type == '2' ? symlink(link.link.c_str(), path.c_str())
+                                          : ::link(link.link.c_str(), path.c_str());
+            if (result != 0) {
+                stats.recordError(path, errno);
+                continue;
+            }
+            if (link.type == '2') {
+                struct timespec times[2] = {{0, UTIME_OMIT}, {static_cast<time_t>(link.mtime), 0}};
+                utimensat(AT_FDCWD, path.c_str(), times, AT_SYMLINK_NOFOLLOW);
+                stats.symlinks++;
+            } else {
+                stats.files++;
+            }
+        }
+        std::sort(directories.begin(), directories.end(),
+                  [](const auto& a, const auto& b) { return a.first.size() > b.first.size(); });
+        for (const auto& [path, directory] : directories) {
+            chmod(path.c_str(), directory.mode & 07777);
+            struct timespec times[2] = {{0, UTIME_OMIT}, {static_cast<time_t>(directory.mtime), 0}};
+            utimensat(AT_FDCWD, path.c_str(), times, 0);
+        }
+        stats.archiveBytes = input.bytesRead();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    struct FileData {
+        struct stat st {};
+        std::string content;
+        int error = 0;
+    };
+
+    struct StreamEntry {
+        std::string path;
+        struct stat st {};
+    };
+
+    struct Pending {
+        StreamEntry entry;
+        std::future<FileData> data;
+    };
+
+    class TreeStream {
+    public:
+        TreeStream(const fs::path& root, const std::string& prefix, ArchiveStats& stats)
+            : prefix(prefix), stats(stats) {
+            int fd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0 || fstat(fd, &rootEntry.st) != 0) {
+                int error = errno;
+                if (fd >= 0) close(fd);
+                throw fs::filesystem_error("cannot open directory", root, std::error_code(error, std::generic_category()));
+            }
+            push(fd, "");
+        }
+
+        TreeStream(const TreeStream&) = delete;
+        TreeStream& operator=(const TreeStream&) = delete;
+
+        ~TreeStream() {
+            for (auto& frame : frames) close(frame.fd);
+        }
+
+        bool next(StreamEntry& out) {
+            if (rootPending) {
+                rootPending = false;
+                out = rootEntry;
+                return true;
+            }
+            while (!frames.empty()) {
+                Frame& frame = frames.back();
+                if (frame.next == frame.names.size()) {
+                    close(frame.fd);
+                    frames.pop_back();
+                    continue;
+                }
+                std::string name = frame.names[frame.next++];
+                int parent = frame.fd;
+                out.path = frame.dir.empty() ? name : frame.dir + "/" + name;
+                Instrumentation::add(Counter::Syscalls);
+                if (fstatat(parent, name.c_str(), &out.st, AT_SYMLINK_NOFOLLOW) != 0) {
+                    stats.recordError(prefix + out.path, errno);
+                    continue;
+                }
+                if (S_ISDIR(out.st.st_mode)) {
+                    int child = openat(parent, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                    if (child < 0) {
+                        stats.recordError(prefix + out.path, errno);
+                    } else {
+                        push(child, out.path);
+                    }
+                }
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        struct Frame {
+            int fd;
+            std::string dir;
+            std::vector<std::string> names;
+            size_t next = 0;
+        };
+
+        std::string prefix;
+        ArchiveStats& stats;
+        StreamEntry rootEntry;
+        bool rootPending = true;
+        std::vector<Frame> frames;
+
+        void push(int fd, const std::string& dir) {
+            Frame frame{fd, dir, {}, 0};
+            std::vector<char> buffer(64 * 1024);
+            long bytes;
+            while ((bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size())) > 0) {
+                Instrumentation::add(Counter::Syscalls);
+                for (long offset = 0; offset < bytes;) {
+                    auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+                    offset += dirent->d_reclen;
+                    const char* name = dirent->d_name;
+                    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+                    frame.names.emplace_back(name);
+                }
+            }
+            if (bytes < 0) stats.recordError(prefix + dir, errno);
+            std::sort(frame.names.begin(), frame.names.end());
+            frames.push_back(std::move(frame));
+        }
+    };
+
+    struct Header {
+        std::string path;
+        std::string link;
+        uintmax_t size = 0;
+        int64_t mtime = 0;
+        uint32_t mode = 0644;
+        char type = '0';
+    };
+
+    struct PaxOverrides {
+        std::string path;
+        std::string link;
+        uintmax_t size = UINTMAX_MAX;
+        int64_t mtime = -1;
+    };
+
+    static FileData readWhole(const std::string& path) {
+        ScopedTimer timer("archive.readahead");
+        FileData data;
+        int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0 || fstat(fd, &data.st) != 0) {
+            data.error = errno;
+            if (fd >= 0) close(fd);
+            return data;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        data.content.resize(static_cast<size_t>(data.st.st_size));
+        size_t filled = 0;
+        while (filled < data.content.size()) {
+            ssize_t bytes = ::read(fd, data.content.data() + filled, data.content.size() - filled);
+            if (bytes < 0 && errno == EINTR) continue;
+            if (bytes < 0) {
+                data.error = errno;
+                break;
+            }
+            if (bytes == 0) break;
+            filled += static_cast<size_t>(bytes);
+        }
+        data.content.resize(filled);
+        close(fd);
+        return data;
+    }
+
+    static void streamFile(ArchiveOutput& output, const std::string& name, const std::string& path,
+                           ArchiveStats& stats) {
+        int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            stats.recordError(path, errno);
+            if (fd >= 0) close(fd);
+            return;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        uintmax_t size = static_cast<uintmax_t>(st.st_size);
+        writeHeader(output, name, '0', st, size, "");
+        std::string buffer(ArchiveOutput::blockBytes, '\0');
+        uintmax_t left = size;
+        while (left > 0) {
+            ssize_t bytes = ::read(fd, buffer.data(), static_cast<size_t>(std::min<uintmax_t>(left, buffer.size())));
+            if (bytes < 0 && errno == EINTR) continue;
+            if (bytes <= 0) {
+                stats.recordError(path, bytes < 0 ? errno : ENODATA);
+                break;
+            }
+            output.write(std::string_view(buffer.data(), static_cast<size_t>(bytes)));
+            left -= static_cast<uintmax_t>(bytes);
+        }
+        close(fd);
+        for (std::string zeros(buffer.size(), '\0'); left > 0;) {
+            size_t take = static_cast<size_t>(std::min<uintmax_t>(left, zeros.size()));
+            output.write(std::string_view(zeros.data(), take));
+            left -= take;
+        }
+        pad(output, size);
+        stats.files++;
+        stats.bytes += size;
+    }
+
+    static uintmax_t padding(uintmax_t size) {
+        return (blockSize - size % blockSize) % blockSize;
+    }
+
+    static void pad(ArchiveOutput& output, uintmax_t size) {
+        static const char zeros[blockSize] = {};
+        output.write(std::string_view(zeros, static_cast<size_t>(padding(size))));
+    }
+
+    static void putOctal(char* field, size_t width, uintmax_t value) {
+        field[width - 1] = '\0';
+        for (size_t i = width - 1; i-- > 0; value >>= 3) field[i] = static_cast<char>('0' + (value & 7));
+    }
+
+    static void paxRecord(std::string& out, const char* key, const std::string& value) {
+        size_t length = strlen(key) + value.size() + 3;
+        size_t digits = std::to_string(length).size();
+        if (std::to_string(length + digits).size() > digits) digits++;
+        out += std::to_string(length + digits) + " " + key + "=" + value + "\n";
+    }
+
+    static void writeHeader(ArchiveOutput& output, const std::string& name, char type, const struct stat& st,
+                            uintmax_t size, const std::string& link) {
+        constexpr uintmax_t maxOctalSize = 077777777777ULL;
+        std::string nameField = name;
+        std::string prefixField;
+        std::string pax;
+        if (name.size() > 100) {
+            size_t split = name.rfind('/', std::min<size_t>(name.size() - 1, 155));
+            if (split != std::string::npos && split > 0 && name.size() - split - 1 <= 100) {
+                prefixField = name.substr(0, split);
+                nameField = name.substr(split + 1);
+            } else {
+                paxRecord(pax, "path", name);
+                nameField = name.substr(0, 100);
+            }
+        }
+        if (link.size() > 100) paxRecord(pax, "linkpath", link);
+        if (size > maxOctalSize) paxRecord(pax, "size", std::to_string(size));
+        if (!pax.empty()) {
+            struct stat none {};
+            none.st_mode = 0644;
+            none.st_mtime = st.st_mtime;
+            output.write(encodeHeader("././@PaxHeader", "", 'x', none, pax.size(), ""));
+            output.write(pax);
+            pad(output, pax.size());
+        }
+        output.write(encodeHeader(nameField, prefixField, type, st, size > maxOctalSize ? 0 : size,
+                                  link.substr(0, 100)));
+    }
+
+    static std::string encodeHeader(const std::string& name, const std::string& prefix, char type,
+                                    const struct stat& st, uintmax_t size, const std::string& link) {
+        char block[blockSize] = {};
+        std::memcpy(block, name.data(), std::min<size_t>(name.size(), 100));
+        putOctal(block + 100, 8, st.st_mode & 07777);
+        putOctal(block + 108, 8, st.st_uid <= 07777777 ? st.st_uid : 0);
+        putOctal(block + 116, 8, st.st_gid <= 07777777 ? st.st_gid : 0);
+        putOctal(block + 124, 12, size);
+        putOctal(block + 136, 12, st.st_mtime > 0 ? static_cast<uintmax_t>(st.st_mtime) : 0);
+        block[156] = type;
+        std::memcpy(block + 157, link.data(), std::min<size_t>(link.size(), 100));
+        std::memcpy(block + 257, "ustar", 6);
+        std::memcpy(block + 263, "00", 2);
+        std::memcpy(block + 345, prefix.data(), std::min<size_t>(prefix.size(), 155));
+        std::memset(block + 148, ' ', 8);
+        unsigned checksum = 0;
+        for (unsigned char c : block) checksum += c;
+        snprintf(block + 148, 8, "%06o", checksum);
+        return std::string(block, blockSize);
+    }
+
+    static uintmax_t parseOctal(const char* field, size_t width) {
+        uintmax_t value = 0;
+        size_t i = 0;
+        while (i < width && (field[i] == ' ' || field[i] == '\0')) i++;
+        for (; i < width && field[i] >= '0' && field[i] <= '7'; i++) value = value * 8 + (field[i] - '0');
+        return value;
+    }
+
+    [[noreturn]] static void truncated() {
+        throw fs::filesystem_error("truncated or corrupt archive", std::make_error_code(std::errc::invalid_argument));
+    }
+
+    static bool readHeader(ArchiveInput& input, Header& header) {
+        char block[blockSize];
+        if (!input.read(block, blockSize)) truncated();
+        if (std::all_of(block, block + blockSize, [](char c) { return c == '\0'; })) return false;
+        unsigned stored = static_cast<unsigned>(parseOctal(block + 148, 8));
+        std::memset(block + 148, ' ', 8);
+        unsigned checksum = 0;
+        for (unsigned char c : block) checksum += c;
+        if (checksum != stored) truncated();
+        header = Header{};
+        header.path.assign(block, strnlen(block, 100));
+        if (std::memcmp(block + 257, "ustar", 5) == 0 && block[345] != '\0') {
+            header.path = std::string(block + 345, strnlen(block + 345, 155)) + "/" + header.path;
+        }
+        header.link.assign(block + 157, strnlen(block + 157, 100));
+        header.mode = static_cast<uint32_t>(parseOctal(block + 100, 8));
+        header.size = parseOctal(block + 124, 12);
+        header.mtime = static_cast<int64_t>(parseOctal(block + 136, 12));
+        header.type = block[156];
+        if (header.type == '\0' && !header.path.empty() && header.path.back() == '/') header.type = '5';
+        return true;
+    }
+
+    static void applyPax(const std::string& payload, PaxOverrides& overrides) {
+        size_t position = 0;
+        while (position < payload.size()) {
+            size_t space = payload.find(' ', position);
+            if (space == std::string::npos) break;
+            size_t length = std::strtoull(payload.c_str() + position, nullptr, 10);
+            if (length == 0 || position + length > payload.size()) break;
+            std::string record = payload.substr(space + 1, position + length - space - 2);
+            position += length;
+            size_t equals = record.find('=');
+            if (equals == std::string::npos) continue;
+            std::string key = record.substr(0, equals);
+            std::string value = record.substr(equals + 1);
+            if (key == "path") overrides.path = value;
+            else if (key == "linkpath") overrides.link = value;
+            else if (key == "size") overrides.size = std::strtoull(value.c_str(), nullptr, 10);
+            else if (key == "mtime") overrides.mtime = std::strtoll(value.c_str(), nullptr, 10);
+        }
+    }
+
+    static void mergePending(Header& header, PaxOverrides& pending) {
+        if (!pending.path.empty()) header.path = pending.path;
+        if (!pending.link.empty()) header.link = pending.link;
+        if (pending.size != UINTMAX_MAX) header.size = pending.size;
+        if (pending.mtime >= 0) header.mtime = pending.mtime;
+        pending = PaxOverrides{};
+    }
+
+    static std::string safeRelative(const std::string& name) {
+        fs::path normal = fs::path(name).lexically_normal().relative_path();
+        for (const auto& part : normal) {
+            if (part == "..") return "";
+        }
+        std::string result = normal.string();
+        while (!result.empty() && result.back() == '/') result.pop_back();
+        return result == "." ? "" : result;
+    }
+
+    static void ensureParent(const fs::path& target, const fs::path& destination, std::set<std::string>& created) {
+        fs::path parent = target.parent_path();
+        if (parent == destination || created.count(parent.string())) return;
+        std::error_code ec;
+        fs::create_directories(parent, ec);
+        for (fs::path p = parent; p != destination && p.has_relative_path(); p = p.parent_path()) {
+            if (!created.insert(p.string()).second) break;
+        }
+    }
+
+    static int createFile(const std::string& path, uint32_t mode) {
+        int flags = O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC;
+        int fd = open(path.c_str(), flags, 0600);
+        if (fd < 0 && (errno == ELOOP || errno == ETXTBSY || errno == EISDIR)) {
+            if (errno == EISDIR) rmdir(path.c_str());
+            else unlink(path.c_str());
+            fd = open(path.c_str(), flags, 0600);
+        }
+        if (fd >= 0) fchmod(fd, mode & 07777);
+        return fd;
+    }
+
+    static bool writeFully(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t bytes = ::write(fd, data, size);
+            if (bytes < 0 && errno == EINTR) continue;
+            if (bytes < 0) return false;
+            data += bytes;
+            size -= static_cast<size_t>(bytes);
+        }
+        return true;
+    }
+
+    static void finishFile(int fd, const Header& header) {
+        struct timespec times[2] = {{0, UTIME_OMIT}, {static_cast<time_t>(header.mtime), 0}};
+        futimens(fd, times);
+        close(fd);
+    }
+};
+
+class FuzzyCandidates {
+public:
+    size_t size() const { return directories.size(); }
+    uintmax_t arenaBytes() const { return text.size(); }
+    double loadSeconds() const { return seconds; }
+
+    std::string_view path(uint32_t i) const { return std::string_view(text.data() + starts[i], starts[i + 1] - starts[i]); }
+    std::string_view folded(uint32_t i) const {
+        return std::string_view(lowered.data() + starts[i], starts[i + 1] - starts[i]);
+    }
+    bool isDirectory(uint32_t i) const { return directories[i]; }
+
+    void loadFromIndex(const FileIndex& index) {
+        ScopedTimer timer("fuzzy.load");
+        auto start = std::chrono::steady_clock::now();
+        reset();
+        index.forEachEntry([&](std::string_view path, bool isDir) { add(path, isDir); });
+        finish(start);
+    }
+
+    void loadFromList(const std::vector<std::string>& paths) {
+        auto start = std::chrono::steady_clock::now();
+        reset();
+        for (const auto& path : paths) add(path, false);
+        finish(start);
+    }
+
+    void loadFromWalk(const fs::path& root) {
+        ScopedTimer timer("fuzzy.load");
+        auto start = std::chrono::steady_clock::now();
+        reset();
+        std::string prefix = root.string();
+        if (prefix.empty() || prefix.back() != '/') prefix += '/';
+        std::mutex lock;
+        ParallelWalker walker;
+        walker.walk(root, [&](const WalkEntry& entry) {
+            std::string_view relative(entry.path);
+            relative.remove_prefix(std::min(prefix.size(), relative.size()));
+            std::lock_guard<std::mutex> guard(lock);
+            add(relative, entry.type == DT_DIR);
+            return entry.type == DT_DIR;
+        });
+        finish(start);
+    }
+
+private:
+    std::string text;
+    std::string lowered;
+    std::vector<uint64_t> starts;
+    std::vector<bool> directories;
+    double seconds = 0;
+
+    void reset() {
+        text.clear();
+        lowered.clear();
+        starts.clear();
+        directories.clear();
+    }
+
+    void add(std::string_view path, bool isDirectory) {
+        starts.push_back(text.size());
+        text.append(path);
+        directories.push_back(isDirectory);
+    }
+
+    void finish(std::chrono::steady_clock::time_point start) {
+        starts.push_back(text.size());
+        lowered.resize(text.size());
+        std::transform(text.begin(), text.end(), lowered.begin(),
+                       [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        Instrumentation::add(Counter::Entries, size());
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+class FuzzyScorer {
+public:
+    static constexpr int scoreMatch = 16;
+    static constexpr int gapStart = -3;
+    static constexpr int gapExtension = -1;
+    static constexpr int bonusBoundary = scoreMatch / 2;
+    static constexpr int bonusNonWord = scoreMatch / 2;
+    static constexpr int bonusCamel = bonusBoundary + gapExtension;
+    static constexpr int bonusConsecutive = -(gapStart + gapExtension);
+    static constexpr int bonusBoundaryDelimiter = bonusBoundary + 1;
+    static constexpr int bonusBoundaryWhite = bonusBoundary + 2;
+    static constexpr int bonusFirstCharMultiplier = 2;
+
+    explicit FuzzyScorer(const std::string& query) {
+        caseSensitive = std::any_of(query.begin(), query.end(), [](char c) { return std::isupper(static_cast<unsigned char>(c)); });
+        std::string term;
+        for (char c : query) {
+            if (c == ' ') {
+                if (!term.empty()) terms.push_back(term);
+                term.clear();
+            } else {
+                term += caseSensitive ? c : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+        }
+        if (!term.empty()) terms.push_back(term);
+    }
+
+    bool empty() const { return terms.empty(); }
+
+    bool score(std::string_view text, std::string_view folded, int& total, std::vector<size_t>* positions = nullptr) const {
+        std::string_view haystack = caseSensitive ? text : folded;
+        total = 0;
+        for (const auto& term : terms) {
+            size_t begin, end;
+            if (!locate(haystack, term, begin, end)) return false;
+            total += scoreRange(text, haystack, term, begin, end, positions);
+        }
+        return true;
+    }
+
+private:
+    enum CharClass { White, NonWord, Delimiter, Lower, Upper, Number };
+
+    std::vector<std::string> terms;
+    bool caseSensitive = false;
+
+    static CharClass classOf(char c) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (u >= 'a' && u <= 'z') return Lower;
+        if (u >= 'A' && u <= 'Z') return Upper;
+        if (u >= '0' && u <= '9') return Number;
+        if (u >= 0x80) return Lower;
+        if (c == '/' || c == ',' || c == ':' || c == ';' || c == '|') return Delimiter;
+        if (c == ' ' || c == '\t') return White;
+        return NonWord;
+    }
+
+    static int bonusFor(CharClass previous, CharClass current) {
+        if (current > Delimiter) {
+            if (previous == White) return bonusBoundaryWhite;
+            if (previous == Delimiter) return bonusBoundaryDelimiter;
+            if (previous == NonWord) return bonusBoundary;
+        }
+        if ((previous == Lower && current == Upper) || (previous != Number && current == Number)) return bonusCamel;
+        if (current == NonWord || current == Delimiter) return bonusNonWord;
+        if (current == White) return bonusBoundaryWhite;
+        return 0;
+    }
+
+    static bool locate(std::string_view haystack, std::string_view term, size_t& begin, size_t& end) {
+        size_t position = 0;
+        size_t first = std::string_view::npos;
+        for (char c : term) {
+            const void* hit = std::memchr(haystack.data() + position, c, haystack.size() - position);
+            if (!hit) return false;
+            position = static_cast<size_t>(static_cast<const char*>(hit) - haystack.data());
+            if (first == std::string_view::npos) first = position;
+            position++;
+        }
+        end = position;
+        size_t remaining = term.size();
+        begin = end;
+        while (remaining > 0 && begin > first) {
+            if (haystack[--begin] == term[remaining - 1]) remaining--;
+        }
+        if (remaining > 0) begin = first;
+        return true;
+    }
+
+    static int scoreRange(std::string_view text, std::string_view haystack, std::string_view term, size_t begin,
+                          size_t end, std::vector<size_t>* positions) {
+        int total = 0;
+        int consecutive = 0;
+        int firstBonus = 0;
+        bool inGap = false;
+        size_t next = 0;
+        CharClass previous = begin > 0 ? classOf(text[begin - 1]) : Delimiter;
+        for (size_t i = begin; i < end; i++) {
+            CharClass current = classOf(text[i]);
+            if (next < term.size() && haystack[i] == term[next]) {
+                total += scoreMatch;
+                int bonus = bonusFor(previous, current);
+                if (consecutive == 0) {
+                    firstBonus = bonus;
+                } else {
+                    if (bonus >= bonusBoundary && bonus > firstBonus) firstBonus = bonus;
+                    bonus = std::max({bonus, firstBonus, bonusConsecutive});
+                }
+                total += next == 0 ? bonus * bonusFirstCharMultiplier : bonus;
+                if (positions) positions->push_back(i);
+                inGap = false;
+                consecutive++;
+                next++;
+            } else {
+                total += inGap ? gapExtension : gapStart;
+                inGap = true;
+                consecutive = 0;
+                firstBonus = 0;
+            }
+            previous = current;
+        }
+        return total;
+    }
+};
+
+class FuzzyFinder {
+public:
+    static constexpr size_t resultLimit = 1000;
+    static constexpr size_t parallelThreshold = 16384;
+
+    struct Result {
+        uint32_t index;
+        int32_t score;
+    };
+
+    explicit FuzzyFinder(const FuzzyCandidates& candidates)
+        : candidates(candidates), threads(std::max(1u, std::thread::hardware_concurrency())),
+          pool(threads, threads * 8) {
+        setQuery("");
+    }
+
+    void setQuery(const std::string& query) {
+        ScopedTimer timer("fuzzy.rank");
+        auto start = std::chrono::steady_clock::now();
+        while (!levels.empty() && (query.size() < levels.back().query.size() ||
+                                   query.compare(0, levels.back().query.size(), levels.back().query) != 0)) {
+            levels.pop_back();
+        }
+        if (levels.empty() || levels.back().query != query) levels.push_back(narrow(query));
+        lastScanned = levels.size() == 1 && query.empty() ? 0 : lastScanned;
+        rank(levels.back());
+        milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const std::vector<Result>& results() const { return ranked; }
+    size_t matchCount() const { return levels.back().all ? candidates.size() : levels.back().matches.size(); }
+    double lastMilliseconds() const { return milliseconds; }
+    size_t scanned() const { return lastScanned; }
+
+    std::vector<size_t> positions(uint32_t index) const {
+        std::vector<size_t> hits;
+        int score;
+        FuzzyScorer(levels.back().query).score(candidates.path(index), candidates.folded(index), score, &hits);
+        std::sort(hits.begin(), hits.end());
+        return hits;
+    }
+
+private:
+    struct Level {
+        std::string query;
+        std::vector<uint32_t> matches;
+        std::vector<int32_t> scores;
+        bool all = false;
+    };
+
+    const FuzzyCandidates& candidates;
+    unsigned threads;
+    TaskPool pool;
+    std::vector<Level> levels;
+    std::vector<Result> ranked;
+    double milliseconds = 0;
+    size_t lastScanned = 0;
+
+    Level narrow(const std::string& query) {
+        Level level{query, {}, {}, false};
+        FuzzyScorer scorer(query);
+        if (scorer.empty() && levels.empty()) {
+            level.all = true;
+            return level;
+        }
+        const Level* base = levels.empty() || levels.back().all ? nullptr : &levels.back();
+        size_t count = base ? base->matches.size() : candidates.size();
+        lastScanned = count;
+        auto scoreSlice = [&](size_t from, size_t to, std::vector<uint32_t>& matches, std::vector<int32_t>& scores) {
+            for (size_t i = from; i < to; i++) {
+                uint32_t index = base ? base->matches[i] : static_cast<uint32_t>(i);
+                int score = 0;
+                if (scorer.score(candidates.path(index), candidates.folded(index), score)) {
+                    matches.push_back(index);
+                    scores.push_back(score);
+                }
+            }
+        };
+
+        if (count < parallelThreshold || threads == 1) {
+            scoreSlice(0, count, level.matches, level.scores);
+            return level;
+        }
+        size_t slices = threads * 4;
+        size_t sliceSize = (count + slices - 1) / slices;
+        std::vector<std::vector<uint32_t>> matches(slices);
+        std::vector<std::vector<int32_t>> scores(slices);
+        for (size_t s = 0; s < slices; s++) {
+            size_t from = s * sliceSize;
+            size_t to = std::min(count, from + sliceSize);
+            if (from >= to) break;
+            pool.submit([&, s, from, to] { scoreSlice(from, to, matches[s], scores[s]); });
+        }
+        pool.wait();
+        for (size_t s = 0; s < slices; s++) {
+            level.matches.insert(level.matches.end(), matches[s].begin(), matches[s].end());
+            level.scores.insert(level.scores.end(), scores[s].begin(), scores[s].end());
+        }
+        return level;
+    }
+
+    void rank(const Level& level) {
+        ranked.clear();
+        if (level.all) {
+            size_t keep = std::min(resultLimit, candidates.size());
+            for (size_t i = 0; i < keep; i++) ranked.push_back(Result{static_cast<uint32_t>(i), 0});
+            return;
+        }
+        std::vector<std::pair<uint64_t, uint32_t>> heap;
+        heap.reserve(resultLimit + 1);
+        auto worse = [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        };
+        for (size_t i = 0; i < level.matches.size(); i++) {
+            uint32_t index = level.matches[i];
+            uint64_t key = rankKey(level.scores[i], candidates.path(index).size());
+            if (heap.size() == resultLimit && !worse(heap.front(), {key, index})) continue;
+            heap.emplace_back(key, index);
+            std::push_heap(heap.begin(), heap.end(), worse);
+            if (heap.size() > resultLimit) {
+                std::pop_heap(heap.begin(), heap.end(), worse);
+                heap.pop_back();
+            }
+        }
+        std::sort_heap(heap.begin(), heap.end(), worse);
+        for (const auto& [key, index] : heap) {
+            ranked.push_back(Result{index, static_cast<int32_t>(static_cast<uint32_t>(key >> 32) ^ 0x80000000u)});
+        }
+    }
+
+    static uint64_t rankKey(int32_t score, size_t length) {
+        uint32_t biased = static_cast<uint32_t>(score) ^ 0x80000000u;
+        return (static_cast<uint64_t>(biased) << 32) | (0xFFFFFFFFu - static_cast<uint32_t>(std::min<size_t>(length, 0xFFFFFFFFu)));
+    }
+};
+
+class WindowedFile {
+public:
+    static constexpr uint64_t windowBytes = 256 * 1024;
+
+    explicit WindowedFile(const fs::path& path) : path(path) {
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw fs::filesystem_error("cannot open file", path, std::error_code(errno, std::generic_category()));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            int error = errno;
+            close(fd);
+            throw fs::filesystem_error("not a regular file", path,
+                                       S_ISREG(st.st_mode) ? std::error_code(error, std::generic_category())
+                                                           : std::make_error_code(std::errc::invalid_argument));
+        }
+        length = static_cast<uint64_t>(st.st_size);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+    }
+
+    WindowedFile(const WindowedFile&) = delete;
+    WindowedFile& operator=(const WindowedFile&) = delete;
+
+    ~WindowedFile() { close(fd); }
+
+    uint64_t size() const { return length; }
+    const fs::path& filePath() const { return path; }
+
+    std::string_view range(uint64_t offset, uint64_t bytes) const {
+        if (offset >= length) return {};
+        bytes = std::min({bytes, length - offset, windowBytes / 2});
+        if (offset < windowStart || offset + bytes > windowStart + window.size()) load(offset);
+        if (offset >= windowStart + window.size()) return {};
+        return std::string_view(window.data() + (offset - windowStart),
+                                static_cast<size_t>(std::min(bytes, windowStart + window.size() - offset)));
+    }
+
+    bool refresh() {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) == length) return false;
+        length = static_cast<uint64_t>(st.st_size);
+        window.clear();
+        return true;
+    }
+
+private:
+    fs::path path;
+    int fd = -1;
+    uint64_t length = 0;
+    mutable std::string window;
+    mutable uint64_t windowStart = 0;
+
+    void load(uint64_t offset) const {
+        uint64_t back = std::min(offset, windowBytes / 4);
+        windowStart = (offset - back) & ~static_cast<uint64_t>(4095);
+        window.resize(static_cast<size_t>(windowBytes));
+        size_t filled = 0;
+        while (filled < window.size()) {
+            ssize_t bytes = pread(fd, window.data() + filled, window.size() - filled,
+                                  static_cast<off_t>(windowStart + filled));
+            if (bytes < 0 && errno == EINTR) continue;
+            if (bytes <= 0) break;
+            filled += static_cast<size_t>(bytes);
+        }
+        window.resize(filled);
+    }
+};
+
+class LineIndex {
+public:
+    static constexpr uint64_t stride = 1024;
+    static constexpr size_t chunkBytes = 1024 * 1024;
+
+    LineIndex(const fs::path& path, uint64_t size) : target(size) {
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        checkpoints.push_back(0);
+        worker = std::thread([this] { run(); });
+    }
+
+    LineIndex(const LineIndex&) = delete;
+    LineIndex& operator=(const LineIndex&) = delete;
+
+    ~LineIndex() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+        if (fd >= 0) close(fd);
+    }
+
+    void resize(uint64_t size) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (size < scanned) {
+                checkpoints.assign(1, 0);
+                scanned = 0;
+                newlines = 0;
+                generation++;
+            }
+            target = size;
+        }
+        wake.notify_all();
+    }
+
+    bool complete() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return scanned >= target;
+    }
+
+    uint64_t indexedBytes() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return scanned;
+    }
+
+    uint64_t lineCount() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return newlines;
+    }
+
+    bool checkpointForLine(uint64_t line, uint64_t& checkpointLine, uint64_t& offset) const {
+        std::lock_guard<std::mutex> guard(lock);
+        uint64_t slot = line / stride;
+        if (slot >= checkpoints.size()) {
+            if (scanned < target) return false;
+            slot = checkpoints.size() - 1;
+        }
+        checkpointLine = slot * stride;
+        offset = checkpoints[slot];
+        return true;
+    }
+
+    bool checkpointForOffset(uint64_t position, uint64_t& checkpointLine, uint64_t& offset) const {
+        std::lock_guard<std::mutex> guard(lock);
+        if (position > scanned) return false;
+        auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), position);
+        size_t slot = static_cast<size_t>(it - checkpoints.begin()) - 1;
+        checkpointLine = slot * stride;
+        offset = checkpoints[slot];
+        return true;
+    }
+
+private:
+    int fd = -1;
+    std::thread worker;
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    std::vector<uint64_t> checkpoints;
+    uint64_t scanned = 0;
+    uint64_t target;
+    uint64_t newlines = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void run() {
+        std::vector<char> buffer(chunkBytes);
+        std::vector<uint64_t> found;
+        while (true) {
+            uint64_t position, limit, count, startGeneration;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [this] { return stopping || (fd >= 0 && scanned < target); });
+                if (stopping) return;
+                position = scanned;
+                limit = target;
+                count = newlines;
+                startGeneration = generation;
+            }
+            ScopedTimer timer("viewer.index");
+            size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size(), limit - position));
+            ssize_t bytes = pread(fd, buffer.data(), want, static_cast<off_t>(position));
+            if (bytes < 0 && errno == EINTR) continue;
+            if (bytes <= 0) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (generation == startGeneration) target = scanned;
+                continue;
+            }
+            found.clear();
+            const char* cursor = buffer.data();
+            const char* end = buffer.data() + bytes;
+            while (const void* hit = std::memchr(cursor, '\n', static_cast<size_t>(end - cursor))) {
+                cursor = static_cast<const char*>(hit) + 1;
+                if (++count % stride == 0) found.push_back(position + static_cast<uint64_t>(cursor - buffer.data()));
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            if (generation != startGeneration) continue;
+            checkpoints.insert(checkpoints.end(), found.begin(), found.end());
+            scanned = position + static_cast<uint64_t>(bytes);
+            newlines = count;
+        }
+    }
+};
+
+class FileViewer {
+public:
+    static constexpr uint64_t maxLineScan = 64 * 1024;
+    static constexpr size_t hexWidth = 16;
+
+    explicit FileViewer(const fs::path& path) : file(path), index(path, file.size()) {
+        std::string_view head = file.range(0, 8192);
+        hexMode = std::memchr(head.data(), '\0', head.size()) != nullptr;
+    }
+
+    WindowedFile& source() { return file; }
+    LineIndex& lines() { return index; }
+    bool hex() const { return hexMode; }
+    void setHex(bool enabled) { hexMode = enabled; }
+
+    bool refresh() {
+        if (!file.refresh()) return false;
+        index.resize(file.size());
+        return true;
+    }
+
+    uint64_t lineStart(uint64_t offset) const {
+        if (hexMode) return offset - offset % hexWidth;
+        offset = std::min(offset, file.size());
+        uint64_t floor = offset > maxLineScan ? offset - maxLineScan : 0;
+        std::string_view window = file.range(floor, offset - floor);
+        size_t newline = window.rfind('\n');
+        return newline == std::string_view::npos ? floor : floor + newline + 1;
+    }
+
+    uint64_t nextRow(uint64_t offset) const {
+        if (hexMode) return std::min(file.size(), offset + hexWidth);
+        std::string_view window = file.range(offset, maxLineScan);
+        size_t newline = window.find('\n');
+        return newline == std::string_view::npos ? offset + window.size() : offset + newline + 1;
+    }
+
+    uint64_t previousRow(uint64_t offset) const {
+        if (offset == 0) return 0;
+        if (hexMode) return offset >= hexWidth ? offset - hexWidth : 0;
+        return lineStart(offset - 1);
+    }
+
+    uint64_t lastPage(size_t rows) const {
+        uint64_t top = lineStart(file.size());
+        if (top == file.size() && top > 0) top = previousRow(top);
+        for (size_t i = 1; i < rows && top > 0; i++) top = previousRow(top);
+        return top;
+    }
+
+    bool offsetOfLine(uint64_t line, uint64_t& offset) const {
+        uint64_t checkpointLine;
+        if (!index.checkpointForLine(line, checkpointLine, offset)) return false;
+        uint64_t position = offset;
+        for (uint64_t skip = checkpointLine; skip < line;) {
+            std::string_view chunk = file.range(position, maxLineScan);
+            if (chunk.empty()) break;
+            const void* hit = std::memchr(chunk.data(), '\n', chunk.size());
+            if (!hit) {
+                position += chunk.size();
+                continue;
+            }
+            position += static_cast<uint64_t>(static_cast<const char*>(hit) - chunk.data()) + 1;
+            offset = position;
+            skip++;
+        }
+        return true;
+    }
+
+    bool lineOfOffset(uint64_t offset, uint64_t& line) const {
+        uint64_t checkpointOffset;
+        if (!index.checkpointForOffset(offset, line, checkpointOffset)) return false;
+        for (uint64_t position = checkpointOffset; position < offset;) {
+            std::string_view chunk = file.range(position, offset - position);
+            if (chunk.empty()) break;
+            line += static_cast<uint64_t>(std::count(chunk.begin(), chunk.end(), '\n'));
+            position += chunk.size();
+        }
+        return true;
+    }
+
+    std::vector<std::string> page(uint64_t top, size_t rows, size_t width) const {
+        ScopedTimer timer("viewer.page");
+        std::vector<std::string> lines;
+        uint64_t offset = top;
+        for (size_t i = 0; i < rows && offset < file.size(); i++) {
+            uint64_t next = nextRow(offset);
+            if (next == offset) break;
+            lines.push_back(hexMode ? hexRow(offset) : textRow(offset, next, width));
+            offset = next;
+        }
+        return lines;
+    }
+
+private:
+    WindowedFile file;
+    LineIndex index;
+    bool hexMode = false;
+
+    std::string textRow(uint64_t offset, uint64_t next, size_t width) const {
+        std::string_view text = file.range(offset, std::min<uint64_t>(next - offset, width * 4));
+        std::string row;
+        size_t column = 0;
+        for (size_t i = 0; i < text.size() && column < width; i++) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c == '\n' || c == '\r') break;
+            if (c == '\t') {
+                size_t spaces = 8 - column % 8;
+                row.append(spaces, ' ');
+                column += spaces;
+            } else if (c < 32 || c == 127) {
+                row += '.';
+                column++;
+            } else {
+                row += static_cast<char>(c);
+                if ((c & 0xC0) != 0x80) column++;
+            }
+        }
+        return row;
+    }
+
+    std::string hexRow(uint64_t offset) const {
+        std::string_view bytes = file.range(offset, hexWidth);
+        char row[128];
+        int used = snprintf(row, sizeof(row), "%012jx  ", static_cast<uintmax_t>(offset));
+        std::string out(row, static_cast<size_t>(used));
+        for (size_t i = 0; i < hexWidth; i++) {
+            if (i < bytes.size()) {
+                snprintf(row, sizeof(row), "%02x ", static_cast<unsigned char>(bytes[i]));
+                out += row;
+            } else {
+                out += "   ";
+            }
+            if (i == 7) out += ' ';
+        }
+        out += " |";
+        for (char c : bytes) out += (c >= 32 && c < 127) ? c : '.';
+        out += '|';
+        return out;
+    }
+};
+
+class RawTerminal {
+public:
+    enum Key { Eof = -1, Enter = 1000, Escape, Backspace, Up, Down, PageUp, PageDown, Home, End };
+
+    RawTerminal() {
+        active = isatty(STDIN_FILENO) && isatty(STDOUT_FILENO) && tcgetattr(STDIN_FILENO, &saved) == 0;
+        if (!active) return;
+        struct termios raw = saved;
+        raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+
+    RawTerminal(const RawTerminal&) = delete;
+    RawTerminal& operator=(const RawTerminal&) = delete;
+
+    ~RawTerminal() {
+        if (active) tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+
+    bool isActive() const { return active; }
+
+    int readKey() {
+        unsigned char c;
+        if (read(STDIN_FILENO, &c, 1) != 1) return Eof;
+        if (c == '\r' || c == '\n') return Enter;
+        if (c == 127 || c == '\b') return Backspace;
+        if (c != '\033') return c;
+
+        unsigned char prefix;
+        if (!readPending(prefix) || (prefix != '[' && prefix != 'O')) return Escape;
+        unsigned char code;
+        if (!readPending(code)) return Escape;
+        switch (code) {
+            case 'A': return Up;
+            case 'B': return Down;
+            case 'H': return Home;
+            case 'F': return End;
+        }
+        if (code < '0' || code > '9') return Escape;
+        unsigned char tilde;
+        if (!readPending(tilde) || tilde != '~') return Escape;
+        switch (code) {
+            case '1': case '7': return Home;
+            case '4': case '8': return End;
+            case '5': return PageUp;
+            case '6': return PageDown;
+        }
+        return Escape;
+    }
+
+    static bool inputPending() {
+        struct pollfd pending{STDIN_FILENO, POLLIN, 0};
+        return poll(&pending, 1, 0) > 0;
+    }
+
+private:
+    struct termios saved {};
+    bool active = false;
+
+    static bool readPending(unsigned char& c) {
+        struct pollfd pending{STDIN_FILENO, POLLIN, 0};
+        return poll(&pending, 1, 50) > 0 && read(STDIN_FILENO, &c, 1) == 1;
+    }
+};
+
+class TerminalRenderer {
+public:
+    explicit TerminalRenderer(int fd = STDOUT_FILENO) : fd(fd) { updateSize(); }
+
+    int rows() const { return height; }
+    int columns() const { return width; }
+
+    void beginFrame() {
+        next.clear();
+        if (updateSize()) invalidate();
+    }
+
+    void addLine(std::string_view line) { next.push_back(fit(line)); }
+
+    void invalidate() {
+        previous.clear();
+        fullRedraw = true;
+    }
+
+    size_t present() {
+        ScopedTimer timer("render.present");
+        std::string out = "\033[?25l";
+        if (fullRedraw) out += "\033[H\033[2J";
+        size_t lines = std::min(next.size(), static_cast<size_t>(height));
+        for (size_t i = 0; i < lines; i++) {
+            if (!fullRedraw && i < previous.size() && previous[i] == next[i]) continue;
+            moveTo(out, i);
+            out += next[i];
+            out += "\033[K";
+        }
+        if (lines < previous.size()) {
+            moveTo(out, lines);
+            out += "\033[J";
+        }
+        moveTo(out, lines > 0 ? lines - 1 : 0);
+        out += "\033[?25h";
+        writeAll(out);
+        next.resize(lines);
+        previous.swap(next);
+        fullRedraw = false;
+        return out.size();
+    }
+
+    void finish() {
+        std::string out;
+        moveTo(out, previous.size());
+        out += "\033[J";
+        writeAll(out);
+        invalidate();
+    }
+
+private:
+    int fd;
+    int height = 24;
+    int width = 80;
+    bool fullRedraw = true;
+    std::vector<std::string> previous;
+    std::vector<std::string> next;
+
+    bool updateSize() {
+        struct winsize ws;
+        if (ioctl(fd, TIOCGWINSZ, &ws) != 0 || ws.ws_row == 0 || ws.ws_col == 0) return false;
+        bool changed = ws.ws_row != height || ws.ws_col != width;
+        height = ws.ws_row;
+        width = ws.ws_col;
+        return changed;
+    }
+
+    std::string fit(std::string_view line) const {
+        int visible = 0;
+        bool escape = false;
+        for (size_t i = 0; i < line.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(line[i]);
+            if (escape) {
+                if (c >= '@' && c <= '~' && c != '[') escape = false;
+                continue;
+            }
+            if (c == '\033') {
+                escape = true;
+                continue;
+            }
+            if ((c & 0xC0) == 0x80) continue;
+            if (++visible > width) return std::string(line.substr(0, i)) + "\033[0m";
+        }
+        return std::string(line);
+    }
+
+    static void moveTo(std::string& out, size_t row) {
+        out += "\033[";
+        out += std::to_string(row + 1);
+        out += ";1H";
+    }
+
+    void writeAll(std::string_view data) {
+        while (!data.empty()) {
+            ssize_t written = write(fd, data.data(), data.size());
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            data.remove_prefix(static_cast<size_t>(written));
+        }
+    }
+};
+
+class FileExplorer {
+private:
+    static constexpr size_t pagedListingThreshold = 20000;
+    static constexpr size_t listingPageSize = 40;
+    
+    fs::path currentPath;
+    FileIndex index;
+    DirectoryWatcher watcher;
+    MetadataCache metadata{256};
+    DirectoryPrefetcher prefetcher{metadata};
+    SizeTree sizeTree;
+    SelectionSet selection;
+    std::vector<std::string> lastSearchResults;
+
+    void clearScreen() {
+        std::cout << "\033[2J\033[1;1H";
+    }
+
+    void displayHeader() {
+        std::cout << "\n╔════════════════════════════════════════════════════════════════╗\n";
+        std::cout << "║           CONSOLE-BASED FILE EXPLORER APPLICATION              ║\n";
+        std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
+        std::cout << "Current Directory: " << currentPath << "\n";
+        std::cout << "================================================================\n\n";
+    }
+
+    void displayMenu() {
+        std::cout << "\n┌─────────────────── MAIN MENU ───────────────────┐\n";
+        std::cout << "│  1.  List Files and Directories                 │\n";
+        std::cout << "│  2.  Change Directory                            │\n";
+        std::cout << "│  3.  Create New File                             │\n";
+        std::cout << "│  4.  Create New Directory                        │\n";
+        std::cout << "│  5.  Copy File                                   │\n";
+        std::cout << "│  6.  Move File                                   │\n";
+        std::cout << "│  7.  Delete File                                 │\n";
+        std::cout << "│  8.  Delete Directory                            │\n";
+        std::cout << "│  9.  Search Files                                │\n";
+        std::cout << "│  10. View File Permissions                       │\n";
+        std::cout << "│  11. Change File Permissions                     │\n";
+        std::cout << "│  12. View File Details                           │\n";
+        std::cout << "│  13. Build/Refresh Search Index                  │\n";
+        std::cout << "│  14. Search File Contents                        │\n";
+        std::cout << "│  15. Analyze Disk Usage                          │\n";
+        std::cout << "│  16. Find Duplicate Files                        │\n";
+        std::cout << "│  17. Instrumentation (" << (Instrumentation::enabled() ? "on) " : "off)")
+                  << "                       │\n";
+        std::cout << "│  18. Bulk Change Permissions                     │\n";
+        std::cout << "│  19. Selection & Batch Operations                │\n";
+        std::cout << "│  20. Query Search (size/mtime/type filters)      │\n";
+        std::cout << "│  21. Snapshots & Tree Diff                       │\n";
+        std::cout << "│  22. Export/Import Archive (.tar, .tar.gz)       │\n";
+        std::cout << "│  23. Fuzzy Finder                                │\n";
+        std::cout << "│  24. View File Contents (text/hex)               │\n";
+        std::cout << "│  0.  Exit                                        │\n";
+        std::cout << "└─────────────────────────────────────────────────┘\n";
+        std::cout << "\nEnter your choice: ";
+    }
+
+    std::string getPermissionString(fs::perms p) {
+        std::string result;
+        result += (fs::perms::none != (p & fs::perms::owner_read)) ? "r" : "-";
+        result += (fs::perms::none != (p & fs::perms::owner_write)) ? "w" : "-";
+        result += (fs::perms::none != (p & fs::perms::owner_exec)) ? "x" : "-";
+        result += (fs::perms::none != (p & fs::perms::group_read)) ? "r" : "-";
+        result += (fs::perms::none != (p & fs::perms::group_write)) ? "w" : "-";
+        result += (fs::perms::none != (p & fs::perms::group_exec)) ? "x" : "-";
+        result += (fs::perms::none != (p & fs::perms::others_read)) ? "r" : "-";
+        result += (fs::perms::none != (p & fs::perms::others_write)) ? "w" : "-";
+        result += (fs::perms::none != (p & fs::perms::others_exec)) ? "x" : "-";
+        return result;
+    }
+
+    std::string formatFileSize(uintmax_t size) {
+        const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+        int unitIndex = 0;
+        double fileSize = static_cast<double>(size);
+        
+        while (fileSize >= 1024.0 && unitIndex < 4) {
+            fileSize /= 1024.0;
+            unitIndex++;
+        }
+        
+        char buffer[50];
+        snprintf(buffer, sizeof(buffer), "%.2f %s", fileSize, units[unitIndex]);
+        return std::string(buffer);
+    }
+
+    void displayTreeStats(const TreeCopyStats& stats) {
+        std::cout << "Files: " << stats.files << "  Directories: " << stats.directories
+                  << "  Symlinks: " << stats.symlinks << "\n";
+        printf("Copied %s in %.3fs (%.1f MB/s)\n", formatFileSize(stats.bytes).c_str(), stats.seconds,
+               stats.seconds > 0 ? stats.bytes / stats.seconds / (1024.0 * 1024.0) : 0.0);
+        if (stats.resumed > 0) {
+            std::cout << "Resumed job: " << stats.resumed << " entr(ies) already completed were skipped\n";
+        }
+        if (!stats.errors.empty()) {
+            std::cout << "\n" << stats.errors.size() << " error(s):\n";
+            for (const auto& error : stats.errors) {
+                std::cout << "  " << error << "\n";
+            }
+        }
+    }
+
+    void displayArchiveStats(const ArchiveStats& stats) {
+        std::cout << "Files: " << stats.files << "  Directories: " << stats.directories
+                  << "  Symlinks: " << stats.symlinks << "\n";
+        printf("Processed %s (archive %s) in %.3fs (%.1f MB/s)\n", formatFileSize(stats.bytes).c_str(),
+               formatFileSize(stats.archiveBytes).c_str(), stats.seconds, stats.megabytesPerSecond());
+        if (stats.skipped > 0) std::cout << "Skipped " << stats.skipped << " unsupported entr(ies)\n";
+        if (!stats.errors.empty()) {
+            std::cout << "\n" << stats.errors.size() << " error(s):\n";
+            for (const auto& error : stats.errors) {
+                std::cout << "  " << error << "\n";
+            }
+        }
+    }
+
+    void offerResume() {
+        auto jobs = JobJournal::pending();
+        if (jobs.empty()) return;
+        clearScreen();
+        displayHeader();
+        std::cout << "Interrupted Jobs\n";
+        std::cout << "────────────────\n\n";
+        for (const auto& job : jobs) {
+            std::cout << "Interrupted " << JobJournal::kindName(job.kind) << ": " << job.source;
+            if (!job.target.empty()) std::cout << " -> " << job.target;
+            std::cout << " (" << job.completed << " entr(ies) done)\n";
+            std::cout << "Resume (r), discard (d) or keep for later (k)? ";
+            std::string answer;
+            std::getline(std::cin, answer);
+            
+            try {
+                if (answer == "r" || answer == "R") {
+                    if (job.kind == JobKind::Delete) {
+                        DeleteStats stats;
+                        JobRunner::remove(job.source, stats);
+                        std::cout << (stats.interrupted ? "Interrupted again." : stats.failures.empty()
+                                      ? "Deletion completed." : "Deletion finished with errors.")
+                                  << " Removed " << stats.entries << " entries.\n";
+                    } else {
+                        TreeCopyStats stats;
+                        if (job.kind == JobKind::Copy) {
+                            JobRunner::copy(job.source, job.target, stats);
+                        } else {
+                            JobRunner::move(job.source, job.target, stats);
+                        }
+                        std::cout << (stats.interrupted ? "Interrupted again." : stats.errors.empty()
+                                      ? "Job completed." : "Job finished with errors.") << "\n";
+                        displayTreeStats(stats);
+                    }
+                } else if (answer == "d" || answer == "D") {
+                    JobJournal::discard(job.id);
+                    std::cout << "Journal discarded.\n";
+                }
+            } catch (const fs::filesystem_error& e) {
+                std::cout << "Error: " << e.what() << "\n";
+            }
+            std::cout << "\n";
+        }
+        std::cout << "Press Enter to continue...";
+        std::cin.get();
+    }
+
+public:
+    FileExplorer() {
+        currentPath = fs::current_path();
+    }
+
+    void listFiles() {
+        RawTerminal terminal;
+        if (PagedLister::exceeds(currentPath, pagedListingThreshold)) {
+            if (terminal.isActive()) {
+                browsePagedListing(terminal);
+            } else {
+                listFilesPaged();
+            }
+            return;
+        }
+        if (terminal.isActive()) {
+            browseListing(terminal);
+            return;
+        }
+        
+        clearScreen();
+        displayHeader();
+        std::cout << "Listing contents of: " << currentPath << "\n\n";
+        
+        std::cout << "┌────────────────────────────────────────────────────────────────────────┐\n";
+        std::cout << "│ Type │ Name                              │ Size         │ Permissions │\n";
+        std::cout << "├────────────────────────────────────────────────────────────────────────┤\n";
+        
+        try {
+            ScopedTimer timer("listFiles");
+            auto directorySizes = cachedDirectorySizes();
+            
+            auto printRow = [&](std::string_view name, const EntryStat& st) {
+                std::cout << formatListingRow(name, st, directorySizes) << "\n";
+            };
+            
+            if (watcher.watchListing(currentPath, &metadata)) {
+                ScopedTimer renderTimer("listFiles.render");
+                watcher.forEachListed([&](const ListingEntry& entry) {
+                    printRow(entry.name, entry.stat);
+                });
+            } else {
+                auto table = metadata.listDirectory(currentPath);
+                ScopedTimer renderTimer("listFiles.render");
+                for (size_t i = 0; i < table->size(); i++) {
+                    printRow(table->name(i), table->stat(i));
+                }
+            }
+            
+            std::cout << "└────────────────────────────────────────────────────────────────────────┘\n";
+            prefetcher.prefetchAround(currentPath);
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "Error: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    std::unordered_map<std::string_view, uint64_t> cachedDirectorySizes() {
+        std::unordered_map<std::string_view, uint64_t> directorySizes;
+        uint32_t cachedNode = sizeTree.find(currentPath);
+        if (cachedNode != SizeTree::none) {
+            for (uint32_t child : sizeTree.children(cachedNode)) {
+                directorySizes.emplace(sizeTree.name(child), sizeTree.node(child).totalBytes);
+            }
+        }
+        return directorySizes;
+    }
+
+    std::string formatListingRow(std::string_view name, const EntryStat& st,
+                                 const std::unordered_map<std::string_view, uint64_t>& directorySizes = {}) {
+        std::string type = st.isDirectory() ? "[DIR]" : "[FILE]";
+        std::string size = st.isDirectory() ? "---" : formatFileSize(st.size);
+        if (st.isDirectory()) {
+            auto cached = directorySizes.find(name);
+            if (cached != directorySizes.end()) size = formatFileSize(cached->second);
+        }
+        std::string perms = getPermissionString(st.permissions());
+        
+        char row[512];
+        snprintf(row, sizeof(row), "│ %-4s │ %-33s │ %-12s │ %-11s │",
+                 type.c_str(),
+                 std::string(name.substr(0, 33)).c_str(),
+                 size.c_str(),
+                 perms.c_str());
+        return row;
+    }
+
+    void addListingFrame(TerminalRenderer& renderer, const std::string& position,
+                         const std::vector<std::string>& rows, const char* help) {
+        renderer.beginFrame();
+        renderer.addLine("Listing contents of: " + currentPath.string());
+        renderer.addLine(position);
+        renderer.addLine("");
+        renderer.addLine("┌────────────────────────────────────────────────────────────────────────┐");
+        renderer.addLine("│ Type │ Name                              │ Size         │ Permissions │");
+        renderer.addLine("├────────────────────────────────────────────────────────────────────────┤");
+        for (const auto& row : rows) renderer.addLine(row);
+        renderer.addLine("└────────────────────────────────────────────────────────────────────────┘");
+        renderer.addLine(help);
+    }
+
+    static size_t listingViewport(const TerminalRenderer& renderer) {
+        return static_cast<size_t>(std::max(1, renderer.rows() - 8));
+    }
+
+    std::vector<ListingEntry> loadListing(bool& watched) {
+        std::vector<ListingEntry> entries;
+        watched = watcher.watchListing(currentPath, &metadata);
+        if (watched) {
+            watcher.forEachListed([&](const ListingEntry& entry) { entries.push_back(entry); });
+        } else {
+            auto table = metadata.listDirectory(currentPath);
+            entries.reserve(table->size());
+            for (size_t i = 0; i < table->size(); i++) {
+                entries.push_back(ListingEntry{std::string(table->name(i)), table->stat(i)});
+            }
+        }
+        return entries;
+    }
+
+    void browseListing(RawTerminal& terminal) {
+        std::vector<ListingEntry> entries;
+        bool watched = false;
+        try {
+            entries = loadListing(watched);
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "Error: " << e.what() << "\n\nPress any key to continue..." << std::flush;
+            terminal.readKey();
+            return;
+        }
+        uintmax_t seenEvents = watcher.eventsApplied();
+        auto directorySizes = cachedDirectorySizes();
+        prefetcher.prefetchAround(currentPath);
+        std::cout << std::flush;
+        
+        TerminalRenderer renderer;
+        size_t top = 0;
+        size_t cursor = 0;
+        std::vector<std::string> rows;
+        while (true) {
+            size_t count = entries.size();
+            if (count > 0 && cursor >= count) cursor = count - 1;
+            size_t viewport = listingViewport(renderer);
+            if (cursor < top) top = cursor;
+            if (cursor >= top + viewport) top = cursor - viewport + 1;
+            
+            rows.clear();
+            for (size_t i = top; i < count && i < top + viewport; i++) {
+                std::string row = formatListingRow(entries[i].name, entries[i].stat, directorySizes);
+                rows.push_back(i == cursor ? "\033[7m" + row + "\033[0m" : row);
+            }
+            if (count == 0) rows.push_back("│ (empty directory)                                                      │");
+            std::string position = count == 0 ? "No entries" :
+                "Entries " + std::to_string(top + 1) + "-" + std::to_string(top + rows.size()) +
+                " of " + std::to_string(count);
+            addListingFrame(renderer, position, rows, "↑/↓ move  PgUp/PgDn page  Home/End  q back");
+            renderer.present();
+            
+            if (watched) {
+                pollfd input{STDIN_FILENO, POLLIN, 0};
+                if (poll(&input, 1, 250) == 0) {
+                    if (watcher.eventsApplied() != seenEvents) {
+                        seenEvents = watcher.eventsApplied();
+                        try {
+                            entries = loadListing(watched);
+                        } catch (const fs::filesystem_error&) {
+                        }
+                    }
+                    continue;
+                }
+            }
+            int key = terminal.readKey();
+            if (key == RawTerminal::Eof || key == 'q' || key == 'Q' || key == RawTerminal::Escape) break;
+            if (count == 0) continue;
+            switch (key) {
+                case RawTerminal::Up: case 'k':
+                    if (cursor > 0) cursor--;
+                    break;
+                case RawTerminal::Down: case 'j':
+                    if (cursor + 1 < count) cursor++;
+                    break;
+                case RawTerminal::PageUp: case 'p':
+                    cursor = cursor > viewport ? cursor - viewport : 0;
+                    top = top > viewport ? top - viewport : 0;
+                    break;
+                case RawTerminal::PageDown: case 'n': case ' ':
+                    cursor = std::min(count - 1, cursor + viewport);
+                    top = std::min(count > viewport ? count - viewport : 0, top + viewport);
+                    break;
+                case RawTerminal::Home: case 'g':
+                    cursor = 0;
+                    break;
+                case RawTerminal::End: case 'G':
+                    cursor = count - 1;
+                    break;
+            }
+        }
+        renderer.finish();
+    }
+
+    void browsePagedListing(RawTerminal& terminal) {
+        std::cout << std::flush;
+        TerminalRenderer renderer;
+        PagedLister lister(currentPath, listingViewport(renderer));
+        std::string error;
+        try {
+            if (!lister.firstPage()) return;
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "Error: " << e.what() << "\n\nPress any key to continue..." << std::flush;
+            terminal.readKey();
+            return;
+        }
+        
+        std::vector<std::string> rows;
+        while (true) {
+            const auto& page = lister.page();
+            rows.clear();
+            for (const auto& entry : page) rows.push_back(formatListingRow(entry.name, entry.stat));
+            std::string position = "Entries " + std::to_string(lister.pageStart() + 1) + "-" +
+                std::to_string(lister.pageStart() + page.size()) + " of " + std::to_string(lister.totalEntries());
+            if (!error.empty()) position += "   Error: " + error;
+            addListingFrame(renderer, position, rows, "PgDn/n next page  PgUp/p previous page  q back");
+            renderer.present();
+            
+            int key = terminal.readKey();
+            if (key == RawTerminal::Eof || key == 'q' || key == 'Q' || key == RawTerminal::Escape) break;
+            try {
+                error.clear();
+                if (key == RawTerminal::PageDown || key == RawTerminal::Down || key == 'n' || key == ' ') {
+                    lister.nextPage();
+                } else if (key == RawTerminal::PageUp || key == RawTerminal::Up || key == 'p') {
+                    lister.previousPage();
+                }
+            } catch (const fs::filesystem_error& e) {
+                error = e.code().message();
+            }
+        }
+        renderer.finish();
+    }
+
+    void listFilesPaged() {
+        PagedLister lister(currentPath, listingPageSize);
+        std::string command;
+        bool havePage = false;
+        
+        try {
+            havePage = lister.firstPage();
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "Error: " << e.what() << "\n";
+        }
+        
+        while (havePage) {
+            clearScreen();
+            displayHeader();
+            const auto& page = lister.page();
+            std::cout << "Listing contents of: " << currentPath << "\n";
+            std::cout << "Entries " << lister.pageStart() + 1 << "-" << lister.pageStart() + page.size()
+                      << " of " << lister.totalEntries() << "\n\n";
+            
+            std::cout << "┌────────────────────────────────────────────────────────────────────────┐\n";
+            std::cout << "│ Type │ Name                              │ Size         │ Permissions │\n";
+            std::cout << "├────────────────────────────────────────────────────────────────────────┤\n";
+            for (const auto& entry : page) {
+                std::cout << formatListingRow(entry.name, entry.stat) << "\n";
+            }
+            std::cout << "└────────────────────────────────────────────────────────────────────────┘\n";
+            
+            std::cout << "\n[n] Next page  [p] Previous page  [q] Back to menu: ";
+            if (!std::getline(std::cin, command) || command == "q" || command == "Q") {
+                return;
+            }
+            try {
+                if (command == "n" || command == "N" || command.empty()) {
+                    lister.nextPage();
+                } else if (command == "p" || command == "P") {
+                    lister.previousPage();
+                }
+            } catch (const fs::filesystem_error& e) {
+                std::cout << "Error: " << e.what() << "\n";
+                havePage = false;
+            }
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void changeDirectory() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Change Directory\n";
+        std::cout << "────────────────\n\n";
+        std::cout << "Enter directory path (or '..' for parent, '~' for home): ";
+        
+        std::string newPath;
+        std::getline(std::cin, newPath);
+        
+        try {
+            if (newPath == "~") {
+                currentPath = fs::path(getenv("HOME"));
+            } else if (newPath == "..") {
+                if (currentPath.has_parent_path()) {
+                    currentPath = currentPath.parent_path();
+                }
+            } else {
+                fs::path targetPath = newPath;
+                if (!targetPath.is_absolute()) {
+                    targetPath = currentPath / newPath;
+                }
+                
+                if (fs::exists(targetPath) && fs::is_directory(targetPath)) {
+                    currentPath = fs::canonical(targetPath);
+                } else {
+                    std::cout << "\nError: Directory does not exist!\n";
+                }
+            }
+            std::cout << "\nCurrent directory: " << currentPath << "\n";
+            prefetcher.prefetchAround(currentPath);
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void createFile() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Create New File\n";
+        std::cout << "───────────────\n\n";
+        std::cout << "Enter file name: ";
+        
+        std::string fileName;
+        std::getline(std::cin, fileName);
+        
+        try {
+            fs::path filePath = currentPath / fileName;
+            
+            if (fs::exists(filePath)) {
+                std::cout << "\nError: File already exists!\n";
+            } else {
+                std::ofstream file(filePath);
+                if (file.is_open()) {
+                    file.close();
+                    metadata.invalidate(filePath.parent_path());
+                    std::cout << "\nFile created successfully: " << filePath << "\n";
+                } else {
+                    std::cout << "\nError: Could not create file!\n";
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void createDirectory() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Create New Directory\n";
+        std::cout << "────────────────────\n\n";
+        std::cout << "Enter directory name: ";
+        
+        std::string dirName;
+        std::getline(std::cin, dirName);
+        
+        try {
+            fs::path dirPath = currentPath / dirName;
+            
+            if (fs::exists(dirPath)) {
+                std::cout << "\nError: Directory already exists!\n";
+            } else {
+                if (fs::create_directory(dirPath)) {
+                    metadata.invalidate(dirPath.parent_path());
+                    std::cout << "\nDirectory created successfully: " << dirPath << "\n";
+                } else {
+                    std::cout << "\nError: Could not create directory!\n";
+                }
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void copyFile() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Copy File\n";
+        std::cout << "─────────\n\n";
+        
+        std::string source, destination;
+        
+        std::cout << "Enter source file path: ";
+        std::getline(std::cin, source);
+        
+        std::cout << "Enter destination file path: ";
+        std::getline(std::cin, destination);
+        
+        try {
+            fs::path sourcePath = currentPath / source;
+            fs::path destPath = currentPath / destination;
+            
+            if (!fs::exists(sourcePath)) {
+                std::cout << "\nError: Source file does not exist!\n";
+            } else if (fs::is_directory(sourcePath)) {
+                if (fs::is_directory(destPath)) {
+                    destPath /= sourcePath.filename();
+                }
+                std::cout << "\nCopying directory tree...\n" << std::flush;
+                TreeCopyStats stats;
+                JobRunner::copy(sourcePath, destPath, stats);
+                metadata.invalidate(destPath.parent_path());
+                std::cout << "\nDirectory " << (stats.interrupted ? "copy interrupted, progress was journaled."
+                                                 : stats.errors.empty() ? "copied successfully!" : "copied with errors.")
+                          << "\n";
+                std::cout << "From: " << sourcePath << "\n";
+                std::cout << "To:   " << destPath << "\n";
+                displayTreeStats(stats);
+            } else {
+                auto lastReport = std::chrono::steady_clock::now();
+                CopyResult result = CopyEngine::copyFileAtomic(sourcePath, destPath, 0,
+                    [&](uintmax_t copied, uintmax_t total) {
+                        auto now = std::chrono::steady_clock::now();
+                        if (now - lastReport < std::chrono::milliseconds(200) && copied != total) return;
+                        lastReport = now;
+                        std::cout << "\rCopied " << formatFileSize(copied) << " of " << formatFileSize(total)
+                                  << "        " << std::flush;
+                    });
+                metadata.invalidate(destPath.parent_path());
+                std::cout << "\nFile copied successfully!\n";
+                std::cout << "From: " << sourcePath << "\n";
+                std::cout << "To:   " << destPath << "\n";
+                printf("Method: %s%s, %s in %.3fs (%.1f MB/s)\n",
+                       CopyEngine::methodName(result.method), result.sparse ? " (sparse)" : "",
+                       formatFileSize(result.bytes).c_str(), result.seconds, result.throughputMBps());
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
     }
 
     void moveFile() {
         clearScreen();
         displayHeader();
-        std::cout << "Move File\n";
-        std::cout << "─────────\n\n";
+        std::cout << "Move File\n";
+        std::cout << "─────────\n\n";
+        
+        std::string source, destination;
+        
+        std::cout << "Enter source file path: ";
+        std::getline(std::cin, source);
+        
+        std::cout << "Enter destination file path: ";
+        std::getline(std::cin, destination);
+        
+        try {
+            fs::path sourcePath = currentPath / source;
+            fs::path destPath = currentPath / destination;
+            
+            if (!fs::exists(sourcePath)) {
+                std::cout << "\nError: Source file does not exist!\n";
+            } else {
+                TreeCopyStats stats;
+                JobRunner::move(sourcePath, destPath, stats);
+                metadata.invalidate(sourcePath.parent_path());
+                metadata.invalidate(destPath.parent_path());
+                if (stats.interrupted) {
+                    std::cout << "\nMove interrupted, source was left in place and progress was journaled.\n";
+                } else if (stats.errors.empty()) {
+                    std::cout << "\nFile moved successfully!\n";
+                } else {
+                    std::cout << "\nMove incomplete, source was left in place.\n";
+                }
+                std::cout << "From: " << sourcePath << "\n";
+                std::cout << "To:   " << destPath << "\n";
+                if (stats.crossDevice) {
+                    std::cout << "\nDestination is on another filesystem, copied and removed source.\n";
+                    displayTreeStats(stats);
+                }
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void deleteFile() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Delete File\n";
+        std::cout << "───────────\n\n";
+        
+        std::string fileName;
+        
+        std::cout << "Enter file name to delete: ";
+        std::getline(std::cin, fileName);
+        
+        try {
+            fs::path filePath = currentPath / fileName;
+            
+            if (!fs::exists(filePath)) {
+                std::cout << "\nError: File does not exist!\n";
+            } else if (fs::is_directory(filePath)) {
+                std::cout << "\nError: This is a directory. Use 'Delete Directory' option.\n";
+            } else {
+                std::cout << "\nAre you sure you want to delete '" << fileName << "'? (y/n): ";
+                char confirm;
+                std::cin >> confirm;
+                
+                if (confirm == 'y' || confirm == 'Y') {
+                    fs::remove(filePath);
+                    metadata.invalidate(filePath.parent_path());
+                    std::cout << "\nFile deleted successfully!\n";
+                } else {
+                    std::cout << "\nDeletion cancelled.\n";
+                }
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.ignore();
+        std::cin.get();
+    }
+
+    void deleteDirectory() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Delete Directory\n";
+        std::cout << "────────────────\n\n";
+        
+        std::string dirName;
+        
+        std::cout << "Enter directory name to delete: ";
+        std::getline(std::cin, dirName);
+        
+        try {
+            fs::path dirPath = currentPath / dirName;
+            
+            if (!fs::exists(dirPath)) {
+                std::cout << "\nError: Directory does not exist!\n";
+            } else if (!fs::is_directory(dirPath)) {
+                std::cout << "\nError: This is a file. Use 'Delete File' option.\n";
+            } else {
+                std::cout << "\nAre you sure you want to delete '" << dirName << "' and all its contents? (y/n): ";
+                char confirm;
+                std::cin >> confirm;
+                
+                if (confirm == 'y' || confirm == 'Y') {
+                    DeleteStats stats;
+                    JobRunner::remove(dirPath, stats, [](uintmax_t entries, double seconds) {
+                        printf("\rDeleted %ju entries (%.0f/s)   ", entries, seconds > 0 ? entries / seconds : 0.0);
+                        fflush(stdout);
+                    });
+                    metadata.invalidate(dirPath.parent_path());
+                    if (stats.interrupted) {
+                        std::cout << "\nDeletion interrupted, it will be offered for resume on next start.\n";
+                    } else if (stats.failures.empty()) {
+                        std::cout << "\nDirectory deleted successfully!\n";
+                    } else {
+                        std::cout << "\nDirectory partially deleted, " << stats.failures.size() << " failure(s):\n";
+                        for (const auto& failure : stats.failures) {
+                            std::cout << "  " << failure << "\n";
+                        }
+                    }
+                    printf("Removed %ju entries in %.3fs (%.0f entries/s) using %s\n", stats.entries.load(),
+                           stats.seconds, stats.seconds > 0 ? stats.entries / stats.seconds : 0.0,
+                           stats.usedIoUring ? "io_uring" : "unlinkat");
+                } else {
+                    std::cout << "\nDeletion cancelled.\n";
+                }
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.ignore();
+        std::cin.get();
+    }
+
+    void searchFiles() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Search Files\n";
+        std::cout << "────────────\n\n";
+        
+        std::string searchTerm;
+        
+        std::cout << "Enter file name to search: ";
+        std::getline(std::cin, searchTerm);
+        
+        std::cout << "Match mode - 1: substring, 2: case-insensitive, 3: glob, 4: regex [1]: ";
+        std::string modeChoice;
+        std::getline(std::cin, modeChoice);
+        MatchMode mode = MatchMode::Substring;
+        if (modeChoice == "2") mode = MatchMode::IgnoreCase;
+        else if (modeChoice == "3") mode = MatchMode::Glob;
+        else if (modeChoice == "4") mode = MatchMode::Regex;
+        
+        std::unique_ptr<NameMatcher> matcher;
+        try {
+            matcher = std::make_unique<NameMatcher>(searchTerm, mode);
+        } catch (const std::regex_error& e) {
+            std::cout << "\nError: Invalid regular expression: " << e.what() << "\n";
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+            return;
+        }
+        
+        if (index.load(currentPath)) {
+            bool watched = watcher.keepsIndexCurrent(currentPath);
+            if (watched ? !watcher.indexPending() : index.isFresh()) {
+                searchIndex(*matcher, watched);
+                return;
+            }
+            std::cout << "\nSearch index is stale, falling back to a live walk.\n";
+            index.unload();
+        }
+        
+        std::cout << "Sort results for reproducible output? (y/n): ";
+        std::string sortChoice;
+        std::getline(std::cin, sortChoice);
+        bool deterministic = (sortChoice == "y" || sortChoice == "Y");
+        
+        std::cout << "\nSearching in: " << currentPath << "\n";
+        std::cout << "────────────────────────────────────────────────────────────────\n\n" << std::flush;
+        
+        ParallelWalker walker;
+        std::mutex outputLock;
+        std::vector<std::pair<std::string, bool>> matches;
+        uintmax_t count = 0;
+        auto start = std::chrono::steady_clock::now();
+        
+        lastSearchResults.clear();
+        walker.walk(currentPath, [&](const WalkEntry& entry) {
+            if (matcher->matches(entry.name)) {
+                bool isDir = entry.type == DT_DIR;
+                std::lock_guard<std::mutex> guard(outputLock);
+                lastSearchResults.push_back(entry.path);
+                if (deterministic) {
+                    matches.emplace_back(entry.path, isDir);
+                } else {
+                    std::cout << (isDir ? "[DIR]" : "[FILE]") << " " << std::quoted(entry.path) << "\n";
+                }
+                count++;
+            }
+            return true;
+        });
+        
+        if (deterministic) {
+            ScopedTimer timer("searchFiles.render");
+            std::sort(matches.begin(), matches.end());
+            for (const auto& match : matches) {
+                std::cout << (match.second ? "[DIR]" : "[FILE]") << " " << std::quoted(match.first) << "\n";
+            }
+        }
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        if (count == 0) {
+            std::cout << "No files found matching '" << searchTerm << "'\n";
+        } else {
+            std::cout << "\n────────────────────────────────────────────────────────────────\n";
+            std::cout << "Found " << count << " item(s) matching '" << searchTerm << "'\n";
+        }
+        std::cout << "Scanned " << walker.directoryCount() << " director(ies) with "
+                  << walker.workerCount() << " worker(s) in " << std::fixed << std::setprecision(3)
+                  << seconds << "s\n" << std::defaultfloat;
+        if (walker.errorCount() > 0) {
+            std::cout << "Skipped " << walker.errorCount() << " unreadable director(ies)\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void searchIndex(const NameMatcher& matcher, bool watched) {
+        const std::string& searchTerm = matcher.text();
+        std::cout << "\nSearching index of: " << currentPath << " (built " << index.ageSeconds() << "s ago)\n";
+        if (!watched) {
+            std::cout << "Only the top-level directory is checked for changes; rebuild the index (option 13)\n"
+                      << "if files were added or removed deeper in the tree since then.\n";
+        }
+        std::cout << "────────────────────────────────────────────────────────────────\n\n";
+        
+        uintmax_t count = 0;
+        auto start = std::chrono::steady_clock::now();
+        lastSearchResults.clear();
+        index.search(matcher, [&](const std::string& path, bool isDir) {
+            lastSearchResults.push_back(path);
+            std::cout << (isDir ? "[DIR]" : "[FILE]") << " " << std::quoted(path) << "\n";
+            count++;
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        if (count == 0) {
+            std::cout << "No files found matching '" << searchTerm << "'\n";
+        } else {
+            std::cout << "\n────────────────────────────────────────────────────────────────\n";
+            std::cout << "Found " << count << " item(s) matching '" << searchTerm << "'\n";
+        }
+        std::cout << "Searched " << index.entryCount() << " indexed entries in " << std::fixed
+                  << std::setprecision(3) << seconds * 1000 << "ms\n" << std::defaultfloat;
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void querySearch() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Query Search\n";
+        std::cout << "────────────\n\n";
+        std::cout << FileQuery::syntax() << "\n";
+        std::cout << "Example: type:f size>100M mtime<7d sort:size top:10\n\n";
+        std::cout << "Query: ";
+        std::string text;
+        std::getline(std::cin, text);
+        
+        try {
+            FileQuery query(text);
+            std::cout << "\nSearching in: " << currentPath << "\n";
+            std::cout << "────────────────────────────────────────────────────────────────\n\n" << std::flush;
+            
+            QueryStats stats;
+            lastSearchResults.clear();
+            query.run(currentPath, stats, [&](const QueryMatch& match) {
+                lastSearchResults.push_back(match.path);
+                const char* type = match.type == DT_DIR ? "[DIR]" : match.type == DT_LNK ? "[LINK]" : "[FILE]";
+                if (query.sorted()) {
+                    char when[32];
+                    time_t mtime = static_cast<time_t>(match.mtime);
+                    std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M", std::localtime(&mtime));
+                    printf("%-6s %12s  %s  ", type, formatFileSize(match.size).c_str(), when);
+                } else {
+                    printf("%-6s ", type);
+                }
+                std::cout << std::quoted(match.path) << "\n";
+            });
+            
+            std::cout << "\n────────────────────────────────────────────────────────────────\n";
+            std::cout << (query.sorted() ? "Showing " + std::to_string(lastSearchResults.size()) + " of " : "Found ")
+                      << stats.matches << " match(es)\n";
+            printf("Visited %ju entries, %ju stat call(s), pruned %ju subtree(s) in %.3fs\n",
+                   stats.visited.load(), stats.statCalls.load(), stats.pruned.load(), stats.seconds);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        } catch (const std::regex_error& e) {
+            std::cout << "\nError: Invalid regular expression: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void manageSnapshots() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Snapshots & Tree Diff\n";
+        std::cout << "─────────────────────\n\n";
+        fs::path defaultFile = SnapshotFile::defaultLocation(currentPath);
+        std::cout << "1. Take snapshot of current directory\n";
+        std::cout << "2. Compare snapshot with current directory\n";
+        std::cout << "3. Compare two snapshots\n";
+        std::cout << "\nEnter your choice: ";
+        std::string choice;
+        std::getline(std::cin, choice);
+        
+        try {
+            if (choice == "1") {
+                std::cout << "Snapshot file [" << defaultFile.string() << "]: ";
+                std::string file;
+                std::getline(std::cin, file);
+                fs::path target = file.empty() ? defaultFile : fs::path(file);
+                std::cout << "Hash file contents? (y/n): ";
+                std::string answer;
+                std::getline(std::cin, answer);
+                bool hashes = answer == "y" || answer == "Y";
+                
+                std::vector<SnapshotEntry> previous;
+                std::error_code ec;
+                if (fs::exists(target, ec)) {
+                    std::string previousRoot;
+                    bool previousHashes;
+                    previous = SnapshotFile::load(target, previousRoot, previousHashes);
+                    if (previousRoot != currentPath.string()) previous.clear();
+                }
+                std::cout << "\nCapturing " << currentPath << "...\n" << std::flush;
+                CaptureStats stats;
+                auto entries = TreeSnapshot::capture(currentPath, previous.empty() ? nullptr : &previous, hashes, stats);
+                SnapshotFile::save(target, currentPath.string(), entries, hashes);
+                std::cout << "Snapshot written to: " << target << "\n";
+                printf("Entries: %ju, directories read: %ju, reused: %ju, hashed: %ju file(s) in %.3fs\n",
+                       stats.entries, stats.directoriesRead, stats.directoriesReused, stats.filesHashed.load(),
+                       stats.seconds);
+            } else if (choice == "2" || choice == "3") {
+                std::cout << "Snapshot file [" << defaultFile.string() << "]: ";
+                std::string file;
+                std::getline(std::cin, file);
+                fs::path first = file.empty() ? defaultFile : fs::path(file);
+                
+                std::string root;
+                bool hashes;
+                auto before = SnapshotFile::load(first, root, hashes);
+                std::vector<SnapshotEntry> after;
+                if (choice == "2") {
+                    CaptureStats stats;
+                    after = TreeSnapshot::capture(currentPath, root == currentPath.string() ? &before : nullptr,
+                                                  hashes, stats);
+                } else {
+                    std::cout << "Second snapshot file: ";
+                    std::string second;
+                    std::getline(std::cin, second);
+                    std::string secondRoot;
+                    bool secondHashes;
+                    after = SnapshotFile::load(second, secondRoot, secondHashes);
+                }
+                
+                DiffStats stats;
+                auto changes = TreeDiff::diff(TreeDiff::fromVector(before), TreeDiff::fromVector(after), stats);
+                std::cout << "\n────────────────────────────────────────────────────────────────\n";
+                for (const auto& change : changes) {
+                    std::string line(1, TreeDiff::marker(change.kind));
+                    line += ' ';
+                    if (change.kind == ChangeKind::Renamed) line += change.from + " -> ";
+                    line += change.path;
+                    if (change.type == DT_DIR) line += '/';
+                    if (!change.detail.empty()) line += "  (" + change.detail + ")";
+                    std::cout << line << "\n";
+                }
+                std::cout << "────────────────────────────────────────────────────────────────\n";
+                printf("%ju added, %ju removed, %ju modified, %ju renamed (%ju entries compared)\n",
+                       stats.added, stats.removed, stats.modified, stats.renamed, stats.compared);
+            } else {
+                std::cout << "\nInvalid choice!\n";
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void manageArchives() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Export/Import Archive\n";
+        std::cout << "─────────────────────\n\n";
+        std::cout << "1. Export current directory to archive\n";
+        std::cout << "2. Import archive into current directory\n";
+        std::cout << "\nEnter your choice: ";
+        std::string choice;
+        std::getline(std::cin, choice);
+        
+        try {
+            if (choice == "1") {
+                fs::path defaultFile = currentPath.parent_path() / (currentPath.filename().string() + ".tar.gz");
+                std::cout << "Archive file [" << defaultFile.string() << "]: ";
+                std::string file;
+                std::getline(std::cin, file);
+                fs::path target = file.empty() ? defaultFile : currentPath / file;
+                if (target.lexically_normal().string().rfind(currentPath.string() + "/", 0) == 0) {
+                    std::cout << "\nError: Archive cannot be written inside the directory being exported!\n";
+                } else {
+                    int fd = open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                    if (fd < 0) {
+                        throw fs::filesystem_error("cannot create archive", target,
+                                                   std::error_code(errno, std::generic_category()));
+                    }
+                    std::cout << "\nExporting " << currentPath << "...\n" << std::flush;
+                    ArchiveStats stats;
+                    try {
+                        TarArchive::create(currentPath, fd, TarArchive::wantsCompression(target), stats);
+                    } catch (...) {
+                        close(fd);
+                        throw;
+                    }
+                    close(fd);
+                    std::cout << "Archive written to: " << target << "\n";
+                    displayArchiveStats(stats);
+                }
+            } else if (choice == "2") {
+                std::cout << "Archive file: ";
+                std::string file;
+                std::getline(std::cin, file);
+                fs::path source = currentPath / file;
+                int fd = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    throw fs::filesystem_error("cannot open archive", source,
+                                               std::error_code(errno, std::generic_category()));
+                }
+                std::cout << "\nExtracting into " << currentPath << "...\n" << std::flush;
+                ArchiveStats stats;
+                try {
+                    TarArchive::extract(fd, currentPath, stats);
+                } catch (...) {
+                    close(fd);
+                    throw;
+                }
+                close(fd);
+                displayArchiveStats(stats);
+            } else {
+                std::cout << "\nInvalid choice!\n";
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void loadFuzzyCandidates(FuzzyCandidates& candidates) {
+        if (index.load(currentPath) && index.isFresh()) {
+            candidates.loadFromIndex(index);
+        } else {
+            candidates.loadFromWalk(currentPath);
+        }
+        index.unload();
+    }
+
+    std::string highlightMatches(std::string_view path, const std::vector<size_t>& positions) {
+        std::string line;
+        size_t next = 0;
+        for (size_t i = 0; i < path.size(); i++) {
+            bool hit = next < positions.size() && positions[next] == i;
+            if (hit) {
+                line += "\033[1m";
+                next++;
+            }
+            line += path[i];
+            if (hit) line += "\033[22m";
+        }
+        return line;
+    }
+
+    void fuzzyFind() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Fuzzy Finder\n";
+        std::cout << "────────────\n\n";
+        std::cout << "Loading candidates under " << currentPath << "...\n" << std::flush;
+        FuzzyCandidates candidates;
+        loadFuzzyCandidates(candidates);
+        FuzzyFinder finder(candidates);
+        
+        RawTerminal terminal;
+        if (!terminal.isActive()) {
+            std::cout << "Query: ";
+            std::string query;
+            std::getline(std::cin, query);
+            finder.setQuery(query);
+            lastSearchResults.clear();
+            for (size_t i = 0; i < finder.results().size() && i < 20; i++) {
+                std::string_view path = candidates.path(finder.results()[i].index);
+                lastSearchResults.push_back((currentPath / std::string(path)).string());
+                std::cout << std::string(path) << "\n";
+            }
+            std::cout << "\n" << finder.matchCount() << " of " << candidates.size() << " match(es)\n";
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+            return;
+        }
+        
+        std::cout << std::flush;
+        TerminalRenderer renderer;
+        std::string query;
+        size_t cursor = 0;
+        size_t top = 0;
+        bool chosen = false;
+        while (true) {
+            const auto& results = finder.results();
+            size_t viewport = static_cast<size_t>(std::max(1, renderer.rows() - 5));
+            if (cursor >= results.size()) cursor = results.empty() ? 0 : results.size() - 1;
+            if (cursor < top) top = cursor;
+            if (cursor >= top + viewport) top = cursor - viewport + 1;
+            
+            renderer.beginFrame();
+            renderer.addLine("Fuzzy Finder: " + currentPath.string());
+            renderer.addLine("> " + query + "\033[7m \033[0m");
+            char status[128];
+            snprintf(status, sizeof(status), "  %zu/%zu  (%.1f ms, scanned %zu)", finder.matchCount(),
+                     candidates.size(), finder.lastMilliseconds(), finder.scanned());
+            renderer.addLine(status);
+            for (size_t i = top; i < results.size() && i < top + viewport; i++) {
+                uint32_t index = results[i].index;
+                std::string path(candidates.path(index));
+                if (candidates.isDirectory(index)) path += '/';
+                std::string line = highlightMatches(path, finder.positions(index));
+                renderer.addLine(i == cursor ? "\033[7m> " + line + "\033[0m" : "  " + line);
+            }
+            renderer.addLine("type to filter  ↑/↓ move  Enter open  Ctrl-U clear  Esc back");
+            renderer.present();
+            
+            bool changed = false;
+            bool done = false;
+            do {
+                int key = terminal.readKey();
+                if (key == RawTerminal::Eof || key == RawTerminal::Escape) {
+                    done = true;
+                } else if (key == RawTerminal::Enter) {
+                    chosen = !results.empty();
+                    done = true;
+                } else if (key == RawTerminal::Backspace) {
+                    if (!query.empty()) {
+                        query.pop_back();
+                        changed = true;
+                    }
+                } else if (key == 21) {
+                    changed = !query.empty();
+                    query.clear();
+                } else if (key == RawTerminal::Up || key == 16) {
+                    if (cursor > 0) cursor--;
+                } else if (key == RawTerminal::Down || key == 14) {
+                    cursor++;
+                } else if (key == RawTerminal::PageUp) {
+                    cursor = cursor > viewport ? cursor - viewport : 0;
+                } else if (key == RawTerminal::PageDown) {
+                    cursor += viewport;
+                } else if (key == RawTerminal::Home) {
+                    cursor = 0;
+                } else if (key == RawTerminal::End) {
+                    cursor = results.empty() ? 0 : results.size() - 1;
+                } else if (key >= 32 && key < 256) {
+                    query += static_cast<char>(key);
+                    changed = true;
+                }
+            } while (!done && RawTerminal::inputPending());
+            
+            if (done) break;
+            if (changed) {
+                finder.setQuery(query);
+                cursor = 0;
+                top = 0;
+            }
+        }
+        renderer.finish();
+        
+        if (chosen) {
+            uint32_t index = finder.results()[cursor].index;
+            fs::path target = currentPath / std::string(candidates.path(index));
+            lastSearchResults.assign(1, target.string());
+            currentPath = candidates.isDirectory(index) ? target : target.parent_path();
+        }
+    }
+
+    void buildIndex() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Build/Refresh Search Index\n";
+        std::cout << "──────────────────────────\n\n";
+        
+        bool refresh = index.load(currentPath);
+        std::cout << (refresh ? "Refreshing" : "Building") << " index for: " << currentPath << "\n" << std::flush;
+        
+        FileIndex::BuildStats stats;
+        auto start = std::chrono::steady_clock::now();
+        bool ok = FileIndex::build(currentPath, refresh ? &index : nullptr, stats);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        index.unload();
+        
+        if (ok) {
+            std::cout << "\nIndex written to: " << FileIndex::locationFor(currentPath) << "\n";
+            std::cout << "Entries:               " << stats.entries << "\n";
+            std::cout << "Directories rescanned: " << stats.directoriesRescanned << "\n";
+            std::cout << "Directories reused:    " << stats.directoriesReused << "\n";
+            std::cout << "Time:                  " << std::fixed << std::setprecision(3) << seconds
+                      << "s\n" << std::defaultfloat;
+            
+            std::cout << "\nKeep this index updated in the background? (y/n): ";
+            std::string keepHot;
+            std::getline(std::cin, keepHot);
+            if (keepHot == "y" || keepHot == "Y") {
+                watcher.watchSubtree(currentPath);
+                std::cout << "Watching " << watcher.subtreeWatchCount() << " director(ies) for changes.\n";
+                if (watcher.subtreeWatchLimited()) {
+                    std::cout << "Warning: inotify watch limit reached, falling back to periodic refresh.\n";
+                }
+            }
+        } else {
+            std::cout << "\nError: Could not build index!\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void searchContents() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Search File Contents\n";
+        std::cout << "────────────────────\n\n";
+        
+        std::string searchTerm;
+        
+        std::cout << "Enter text to search for: ";
+        std::getline(std::cin, searchTerm);
+        
+        if (searchTerm.empty()) {
+            std::cout << "\nError: Search text cannot be empty!\n";
+        } else {
+            std::cout << "\nSearching contents under: " << currentPath << "\n";
+            std::cout << "────────────────────────────────────────────────────────────────\n\n" << std::flush;
+            
+            std::mutex outputLock;
+            ContentSearchStats stats;
+            lastSearchResults.clear();
+            ContentSearcher::search(currentPath, searchTerm, stats,
+                [&](const std::string& path, const std::vector<ContentMatch>& matches) {
+                    std::string lines;
+                    for (const auto& match : matches) {
+                        lines += path + ":" + std::to_string(match.line) + ":";
+                        lines.append(match.text);
+                        lines += '\n';
+                    }
+                    std::lock_guard<std::mutex> guard(outputLock);
+                    lastSearchResults.push_back(path);
+                    fwrite(lines.data(), 1, lines.size(), stdout);
+                });
+            fflush(stdout);
+            
+            std::cout << "\n────────────────────────────────────────────────────────────────\n";
+            std::cout << "Found " << stats.matches << " matching line(s) in " << stats.files << " file(s)\n";
+            printf("Scanned %s in %.3fs (%.2f GB/s), skipped %ju binary file(s)\n",
+                   formatFileSize(stats.bytes).c_str(), stats.seconds, stats.gigabytesPerSecond(),
+                   stats.binarySkipped.load());
+            if (stats.errors > 0) {
+                std::cout << "Could not open " << stats.errors << " file(s)\n";
+            }
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void analyzeDiskUsage() {
+        while (true) {
+            clearScreen();
+            displayHeader();
+            std::cout << "Analyze Disk Usage\n";
+            std::cout << "──────────────────\n\n";
+            
+            uint32_t node = sizeTree.find(currentPath);
+            if (node == SizeTree::none) {
+                std::cout << "Scanning " << currentPath << "...\n" << std::flush;
+                auto start = std::chrono::steady_clock::now();
+                sizeTree.build(currentPath);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                node = 0;
+                printf("Scanned %zu director(ies) in %.3fs\n\n", sizeTree.directoryCount(), seconds);
+            } else {
+                printf("Using size tree cached %.0fs ago\n\n", sizeTree.ageSeconds());
+            }
+            
+            const SizeTree::Node& info = sizeTree.node(node);
+            std::cout << "Total: " << formatFileSize(info.totalBytes) << " in " << info.totalFiles << " file(s)\n";
+            
+            std::cout << "\nLargest subdirectories:\n";
+            auto children = sizeTree.children(node);
+            for (size_t i = 0; i < children.size() && i < 15; i++) {
+                const SizeTree::Node& child = sizeTree.node(children[i]);
+                double share = info.totalBytes ? 100.0 * child.totalBytes / info.totalBytes : 0.0;
+                printf("  %12s  %5.1f%%  %s/\n", formatFileSize(child.totalBytes).c_str(), share,
+                       std::string(sizeTree.name(children[i])).c_str());
+            }
+            printf("  %12s  %5.1f%%  (files in this directory)\n", formatFileSize(info.ownBytes).c_str(),
+                   info.totalBytes ? 100.0 * info.ownBytes / info.totalBytes : 0.0);
+            
+            std::cout << "\nHeaviest subtrees:\n";
+            for (uint32_t heavy : sizeTree.heaviestSubtrees(node, 10)) {
+                printf("  %12s  %s\n", formatFileSize(sizeTree.node(heavy).totalBytes).c_str(),
+                       sizeTree.pathOf(heavy).c_str());
+            }
+            
+            std::cout << "\nEnter a subdirectory to drill into, '..' to go up, 'r' to rescan, or Enter to return: ";
+            std::string choice;
+            std::getline(std::cin, choice);
+            if (choice.empty()) {
+                return;
+            } else if (choice == "r" || choice == "R") {
+                sizeTree = SizeTree();
+            } else if (choice == "..") {
+                if (currentPath.has_parent_path()) currentPath = currentPath.parent_path();
+            } else if (sizeTree.find(currentPath / choice) != SizeTree::none) {
+                currentPath = (currentPath / choice).lexically_normal();
+            }
+        }
+    }
+
+    void findDuplicates() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Find Duplicate Files\n";
+        std::cout << "────────────────────\n\n";
+        std::cout << "Scanning: " << currentPath << "\n\n" << std::flush;
         
-        std::string source, destination;
+        DuplicateStats stats;
+        std::vector<DuplicateSet> sets = DuplicateFinder::find(currentPath, stats);
         
-        std::cout << "Enter source file path: ";
-        std::getline(std::cin, source);
+        for (size_t i = 0; i < sets.size() && i < 20; i++) {
+            std::cout << "[" << sets[i].paths.size() << " x " << formatFileSize(sets[i].size) << ", reclaim "
+                      << formatFileSize(sets[i].reclaimableBytes()) << "]\n";
+            for (const auto& path : sets[i].paths) {
+                std::cout << "  " << std::quoted(path) << "\n";
+            }
+        }
+        if (sets.size() > 20) {
+            std::cout << "... and " << sets.size() - 20 << " more set(s)\n";
+        }
         
-        std::cout << "Enter destination file path: ";
-        std::getline(std::cin, destination);
+        std::cout << "\n────────────────────────────────────────────────────────────────\n";
+        std::cout << "Files scanned:          " << stats.filesScanned << "\n";
+        std::cout << "Same-size candidates:   " << stats.sizeCandidates << "\n";
+        std::cout << "After partial hashing:  " << stats.partialCandidates << "\n";
+        std::cout << "Duplicate sets:         " << sets.size() << "\n";
+        std::cout << "Reclaimable space:      " << formatFileSize(stats.reclaimableBytes) << "\n";
+        printf("Hashed %s in %.3fs\n", formatFileSize(stats.bytesHashed).c_str(), stats.seconds);
+        if (stats.errors > 0) {
+            std::cout << "Could not read " << stats.errors << " file(s)\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void manageInstrumentation() {
+        while (true) {
+            clearScreen();
+            displayHeader();
+            std::cout << "Instrumentation\n";
+            std::cout << "───────────────\n\n";
+            std::cout << "Status: " << (Instrumentation::enabled() ? "enabled" : "disabled") << "\n\n";
+            std::cout << "1. " << (Instrumentation::enabled() ? "Disable" : "Enable") << " instrumentation\n";
+            std::cout << "2. Show summary\n";
+            std::cout << "3. Export Chrome trace\n";
+            std::cout << "4. Reset counters and timers\n";
+            std::cout << "0. Back\n\n";
+            std::cout << "Choice: ";
+            
+            std::string choice;
+            if (!std::getline(std::cin, choice) || choice == "0" || choice.empty()) return;
+            
+            if (choice == "1") {
+                Instrumentation::setEnabled(!Instrumentation::enabled());
+                continue;
+            }
+            if (choice == "2") {
+                std::cout << "\n" << Instrumentation::summary();
+            } else if (choice == "3") {
+                std::cout << "Trace file [file_explorer-trace.json]: ";
+                std::string file;
+                std::getline(std::cin, file);
+                if (file.empty()) file = "file_explorer-trace.json";
+                if (Instrumentation::exportChromeTrace(file)) {
+                    std::cout << "Wrote " << std::quoted(file) << " (open in chrome://tracing or Perfetto)\n";
+                } else {
+                    std::cout << "Error: could not write " << std::quoted(file) << "\n";
+                }
+            } else if (choice == "4") {
+                Instrumentation::reset();
+                std::cout << "Instrumentation data cleared.\n";
+            } else {
+                continue;
+            }
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+        }
+    }
+
+    void viewPermissions() {
+        clearScreen();
+        displayHeader();
+        std::cout << "View File Permissions\n";
+        std::cout << "─────────────────────\n\n";
+        
+        std::string fileName;
+        
+        std::cout << "Enter file/directory name: ";
+        std::getline(std::cin, fileName);
         
         try {
-            fs::path sourcePath = currentPath / source;
-            fs::path destPath = currentPath / destination;
+            fs::path filePath = currentPath / fileName;
             
-            if (!fs::exists(sourcePath)) {
-                std::cout << "\nError: Source file does not exist!\n";
+            EntryStat fileStat;
+            if (!metadata.lookup(filePath, fileStat)) {
+                std::cout << "\nError: File/Directory does not exist!\n";
+            } else {
+                auto perms = fileStat.permissions();
+                
+                std::cout << "\nFile: " << filePath << "\n";
+                std::cout << "────────────────────────────────────────────────────────────────\n";
+                std::cout << "Permissions: " << getPermissionString(perms) << "\n";
+                std::cout << "Octal:       " << std::oct << (fileStat.mode & 0777) << std::dec << "\n";
+                std::cout << "\nOwner:  Read=" << ((perms & fs::perms::owner_read) != fs::perms::none ? "Yes" : "No");
+                std::cout << " Write=" << ((perms & fs::perms::owner_write) != fs::perms::none ? "Yes" : "No");
+                std::cout << " Execute=" << ((perms & fs::perms::owner_exec) != fs::perms::none ? "Yes" : "No") << "\n";
+                std::cout << "Group:  Read=" << ((perms & fs::perms::group_read) != fs::perms::none ? "Yes" : "No");
+                std::cout << " Write=" << ((perms & fs::perms::group_write) != fs::perms::none ? "Yes" : "No");
+                std::cout << " Execute=" << ((perms & fs::perms::group_exec) != fs::perms::none ? "Yes" : "No") << "\n";
+                std::cout << "Others: Read=" << ((perms & fs::perms::others_read) != fs::perms::none ? "Yes" : "No");
+                std::cout << " Write=" << ((perms & fs::perms::others_write) != fs::perms::none ? "Yes" : "No");
+                std::cout << " Execute=" << ((perms & fs::perms::others_exec) != fs::perms::none ? "Yes" : "No") << "\n";
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void changePermissions() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Change File Permissions\n";
+        std::cout << "───────────────────────\n\n";
+        
+        std::string fileName;
+        
+        std::cout << "Enter file/directory name: ";
+        std::getline(std::cin, fileName);
+        
+        try {
+            fs::path filePath = currentPath / fileName;
+            
+            struct stat st;
+            if (stat(filePath.c_str(), &st) != 0) {
+                std::cout << "\nError: File/Directory does not exist!\n";
+            } else {
+                std::cout << "\nCurrent permissions: " << getPermissionString(static_cast<fs::perms>(st.st_mode & 07777)) << "\n";
+                std::cout << "\nEnter new permissions (octal like 644, 755 or symbolic like u+x,g-w): ";
+                std::string modeText;
+                std::getline(std::cin, modeText);
+                
+                try {
+                    mode_t target = ModeSpec(modeText).apply(st.st_mode, S_ISDIR(st.st_mode));
+                    if (target == (st.st_mode & 07777)) {
+                        std::cout << "\nPermissions already match; nothing to change.\n";
+                    } else if (fchmodat(AT_FDCWD, filePath.c_str(), target, 0) != 0) {
+                        std::cout << "\nError: " << std::strerror(errno) << "\n";
+                    } else {
+                        metadata.invalidate(filePath.parent_path());
+                        std::cout << "\nPermissions changed successfully!\n";
+                        std::cout << "New permissions: " << getPermissionString(static_cast<fs::perms>(target)) << "\n";
+                    }
+                } catch (const std::exception& e) {
+                    std::cout << "\nError: Invalid permission format!\n";
+                }
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void bulkChangePermissions() {
+        clearScreen();
+        displayHeader();
+        std::cout << "Bulk Change Permissions\n";
+        std::cout << "───────────────────────\n\n";
+        std::cout << "Modes may be octal (644, 755) or symbolic (u+x, g-w, a=rX). Leave blank to keep.\n\n";
+        
+        std::string target, recursive, fileModeText, dirModeText, ownerText, filterText;
+        std::cout << "Target file/directory [.]: ";
+        std::getline(std::cin, target);
+        std::cout << "Recurse into subdirectories? (y/n) [y]: ";
+        std::getline(std::cin, recursive);
+        std::cout << "Mode for files: ";
+        std::getline(std::cin, fileModeText);
+        std::cout << "Mode for directories: ";
+        std::getline(std::cin, dirModeText);
+        std::cout << "Owner as user[:group]: ";
+        std::getline(std::cin, ownerText);
+        std::cout << "Only names matching glob (e.g. *.sh): ";
+        std::getline(std::cin, filterText);
+        
+        try {
+            std::unique_ptr<ModeSpec> fileMode;
+            std::unique_ptr<ModeSpec> dirMode;
+            std::unique_ptr<NameMatcher> filter;
+            BulkChangeOptions options;
+            if (!fileModeText.empty()) fileMode = std::make_unique<ModeSpec>(fileModeText);
+            if (!dirModeText.empty()) dirMode = std::make_unique<ModeSpec>(dirModeText);
+            if (!filterText.empty()) filter = std::make_unique<NameMatcher>(filterText, MatchMode::Glob);
+            if (!ownerText.empty()) options.owner = Ownership::parse(ownerText);
+            options.fileMode = fileMode.get();
+            options.directoryMode = dirMode.get();
+            options.filter = filter.get();
+            options.recursive = recursive != "n" && recursive != "N";
+            
+            if (!fileMode && !dirMode && !options.owner.changes()) {
+                std::cout << "\nNothing to change.\n";
+            } else {
+                fs::path root = target.empty() || target == "." ? currentPath : currentPath / target;
+                std::cout << "\nApplying changes under: " << root << "\n" << std::flush;
+                BulkChangeStats stats;
+                BulkAttributeChanger::apply(root, options, stats);
+                metadata.invalidate(root.parent_path());
+                metadata.invalidate(root);
+                
+                std::cout << "\n────────────────────────────────────────────────────────────────\n";
+                std::cout << "Examined:          " << stats.examined << "\n";
+                std::cout << "Changed:           " << stats.changed << "\n";
+                std::cout << "Already matching:  " << stats.unchanged << "\n";
+                if (filter) std::cout << "Filtered out:      " << stats.filtered << "\n";
+                printf("Completed in %.3fs\n", stats.seconds);
+                if (!stats.failures.empty()) {
+                    std::cout << "Failed:            " << stats.failures.size() << "\n";
+                    for (size_t i = 0; i < stats.failures.size() && i < 10; i++) {
+                        std::cout << "  " << stats.failures[i] << "\n";
+                    }
+                }
+            }
+        } catch (const std::invalid_argument& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void manageSelection() {
+        while (true) {
+            clearScreen();
+            displayHeader();
+            std::cout << "Selection & Batch Operations\n";
+            std::cout << "────────────────────────────\n\n";
+            std::cout << "Selected: " << selection.size() << " path(s)\n\n";
+            std::cout << "1. Add by glob pattern\n";
+            std::cout << "2. Add last search results (" << lastSearchResults.size() << ")\n";
+            std::cout << "3. Add from listing by index\n";
+            std::cout << "4. Show selection\n";
+            std::cout << "5. Clear selection\n";
+            std::cout << "6. Copy selection to directory\n";
+            std::cout << "7. Move selection to directory\n";
+            std::cout << "8. Delete selection\n";
+            std::cout << "9. Change permissions of selection\n";
+            std::cout << "0. Back\n\n";
+            std::cout << "Choice: ";
+            
+            std::string choice;
+            if (!std::getline(std::cin, choice) || choice == "0" || choice.empty()) return;
+            
+            try {
+                if (choice == "1") {
+                    std::string pattern, recursive;
+                    std::cout << "Glob pattern (e.g. *.log): ";
+                    std::getline(std::cin, pattern);
+                    std::cout << "Include subdirectories? (y/n) [n]: ";
+                    std::getline(std::cin, recursive);
+                    NameMatcher matcher(pattern, MatchMode::Glob);
+                    size_t added = selection.addMatching(currentPath, matcher, recursive == "y" || recursive == "Y");
+                    std::cout << "\nAdded " << added << " path(s).\n";
+                } else if (choice == "2") {
+                    size_t added = 0;
+                    for (const auto& path : lastSearchResults) {
+                        if (selection.add(path)) added++;
+                    }
+                    std::cout << "\nAdded " << added << " path(s).\n";
+                } else if (choice == "3") {
+                    auto table = metadata.listDirectory(currentPath);
+                    for (size_t i = 0; i < table->size(); i++) {
+                        printf("%6zu  %s%s\n", i + 1, std::string(table->name(i)).c_str(),
+                               table->stat(i).isDirectory() ? "/" : "");
+                    }
+                    std::cout << "\nIndices (e.g. 1,3,5-9): ";
+                    std::string indices;
+                    std::getline(std::cin, indices);
+                    size_t added = 0;
+                    for (size_t i : SelectionSet::parseIndices(indices, table->size())) {
+                        if (selection.add((currentPath / std::string(table->name(i))).string())) added++;
+                    }
+                    std::cout << "\nAdded " << added << " path(s).\n";
+                } else if (choice == "4") {
+                    for (const auto& path : selection.items()) std::cout << "  " << std::quoted(path) << "\n";
+                    if (selection.empty()) std::cout << "Selection is empty.\n";
+                } else if (choice == "5") {
+                    selection.clear();
+                    continue;
+                } else if (choice >= "6" && choice <= "9" && choice.size() == 1) {
+                    runBatch(choice == "6" ? BatchAction::Copy : choice == "7" ? BatchAction::Move :
+                             choice == "8" ? BatchAction::Delete : BatchAction::Chmod);
+                } else {
+                    continue;
+                }
+            } catch (const fs::filesystem_error& e) {
+                std::cout << "\nError: " << e.what() << "\n";
+            } catch (const std::invalid_argument& e) {
+                std::cout << "\nError: " << e.what() << "\n";
+            } catch (const std::regex_error& e) {
+                std::cout << "\nError: " << e.what() << "\n";
+            }
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+        }
+    }
+
+    void runBatch(BatchAction action) {
+        if (selection.empty()) {
+            std::cout << "\nSelection is empty.\n";
+            return;
+        }
+        fs::path destination;
+        std::unique_ptr<ModeSpec> mode;
+        if (action == BatchAction::Copy || action == BatchAction::Move) {
+            std::cout << "Destination directory: ";
+            std::string target;
+            std::getline(std::cin, target);
+            destination = (fs::path(target).is_absolute() ? fs::path(target) : currentPath / target).lexically_normal();
+        } else if (action == BatchAction::Chmod) {
+            std::cout << "Mode (octal or symbolic): ";
+            std::string modeText;
+            std::getline(std::cin, modeText);
+            mode = std::make_unique<ModeSpec>(modeText);
+        }
+        
+        BatchPlan plan = BatchPlan::build(selection, action, destination, mode.get());
+        std::cout << "\nPlan (" << plan.runnableCount() << " step(s)";
+        if (plan.collapsedCount() > 0) std::cout << ", " << plan.collapsedCount() << " covered by a selected parent";
+        std::cout << "):\n";
+        for (const auto& step : plan.steps()) std::cout << "  " << plan.describe(step) << "\n";
+        if (plan.runnableCount() == 0) return;
+        
+        std::cout << "\nExecute this plan? (y = run, anything else = dry run only): ";
+        std::string confirm;
+        std::getline(std::cin, confirm);
+        if (confirm != "y" && confirm != "Y") {
+            std::cout << "Dry run only; nothing was changed.\n";
+            return;
+        }
+        
+        BatchResult result;
+        plan.execute(result);
+        for (const auto& step : plan.steps()) {
+            metadata.invalidate(fs::path(step.source).parent_path());
+            if (!step.target.empty()) metadata.invalidate(fs::path(step.target).parent_path());
+        }
+        std::cout << "\nCompleted " << result.succeeded << " step(s)";
+        if (result.skipped > 0) std::cout << ", skipped " << result.skipped;
+        printf(" in %.3fs\n", result.seconds);
+        for (const auto& failure : result.failures) std::cout << "  Failed: " << failure << "\n";
+        if (action == BatchAction::Move || action == BatchAction::Delete) {
+            for (const auto& step : plan.steps()) {
+                if (step.skipReason.empty()) selection.remove(step.source);
+            }
+            for (auto it = selection.items().begin(); it != selection.items().end();) {
+                std::string path = *it++;
+                struct stat st;
+                if (lstat(path.c_str(), &st) != 0) selection.remove(path);
+            }
+        }
+    }
+
+    void viewFileDetails() {
+        clearScreen();
+        displayHeader();
+        std::cout << "View File Details\n";
+        std::cout << "─────────────────\n\n";
+        
+        std::string fileName;
+        
+        std::cout << "Enter file/directory name: ";
+        std::getline(std::cin, fileName);
+        
+        try {
+            fs::path filePath = currentPath / fileName;
+            
+            EntryStat fileStat;
+            if (!metadata.lookup(filePath, fileStat)) {
+                std::cout << "\nError: File/Directory does not exist!\n";
+            } else {
+                std::cout << "\n╔═══════════════════ FILE DETAILS ═══════════════════╗\n";
+                std::cout << "║ Name:        " << filePath.filename() << "\n";
+                std::cout << "║ Path:        " << fs::absolute(filePath) << "\n";
+                std::cout << "║ Type:        " << (fileStat.isDirectory() ? "Directory" : "File") << "\n";
+                
+                uint32_t cachedNode = sizeTree.find(filePath);
+                if (fileStat.isRegular()) {
+                    std::cout << "║ Size:        " << formatFileSize(fileStat.size) << "\n";
+                } else if (fileStat.isDirectory() && cachedNode != SizeTree::none) {
+                    std::cout << "║ Size:        " << formatFileSize(sizeTree.node(cachedNode).totalBytes)
+                              << " (" << sizeTree.node(cachedNode).totalFiles << " files, cached)\n";
+                }
+                
+                std::cout << "║ Permissions: " << getPermissionString(fileStat.permissions()) << "\n";
+                
+                std::time_t cftime = fileStat.modifiedSeconds();
+                
+                std::cout << "║ Modified:    " << std::ctime(&cftime);
+                std::cout << "╚════════════════════════════════════════════════════╝\n";
+                
+                if (fileStat.isRegular()) {
+                    std::cout << "\nPress v to view contents, Enter to continue...";
+                    std::string answer;
+                    std::getline(std::cin, answer);
+                    if (answer == "v" || answer == "V") runViewer(filePath);
+                    return;
+                }
+            }
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+        }
+        
+        std::cout << "\nPress Enter to continue...";
+        std::cin.get();
+    }
+
+    void viewFileContents() {
+        clearScreen();
+        displayHeader();
+        std::cout << "View File Contents\n";
+        std::cout << "──────────────────\n\n";
+        std::cout << "Enter file name: ";
+        std::string fileName;
+        std::getline(std::cin, fileName);
+        runViewer(currentPath / fileName);
+    }
+
+    void runViewer(const fs::path& path) {
+        std::unique_ptr<FileViewer> viewer;
+        try {
+            viewer = std::make_unique<FileViewer>(path);
+        } catch (const fs::filesystem_error& e) {
+            std::cout << "\nError: " << e.what() << "\n";
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+            return;
+        }
+        
+        RawTerminal terminal;
+        if (!terminal.isActive()) {
+            for (const auto& line : viewer->page(0, 40, 120)) std::cout << line << "\n";
+            std::cout << "\nPress Enter to continue...";
+            std::cin.get();
+            return;
+        }
+        
+        std::cout << std::flush;
+        TerminalRenderer renderer;
+        int watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watchFd >= 0) inotify_add_watch(watchFd, path.c_str(), IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE);
+        uint64_t top = 0;
+        bool follow = false;
+        char promptKind = 0;
+        std::string prompt;
+        std::string message;
+        uint64_t pendingLine = 0;
+        bool waitingForLine = false;
+        
+        while (true) {
+            bool changed = viewer->refresh();
+            WindowedFile& file = viewer->source();
+            size_t rows = static_cast<size_t>(std::max(1, renderer.rows() - 2));
+            if (changed && top >= file.size()) top = viewer->lastPage(rows);
+            if (changed && follow) top = viewer->lastPage(rows);
+            if (waitingForLine && viewer->offsetOfLine(pendingLine, top)) {
+                waitingForLine = false;
+                message.clear();
+            }
+            
+            renderer.beginFrame();
+            std::vector<std::string> lines = viewer->page(top, rows, static_cast<size_t>(renderer.columns()));
+            for (const auto& line : lines) renderer.addLine(line);
+            for (size_t i = lines.size(); i < rows; i++) renderer.addLine("~");
+            
+            uint64_t line = 0;
+            std::string position = viewer->hex() ? "" : viewer->lineOfOffset(top, line)
+                ? "line " + std::to_string(line + 1) + "  " : "line ?  ";
+            bool indexed = viewer->lines().complete();
+            char status[256];
+            snprintf(status, sizeof(status), "\033[7m %s  %soffset 0x%jx (%.0f%%)  %s%s  %s \033[0m",
+                     path.filename().c_str(), position.c_str(), static_cast<uintmax_t>(top),
+                     file.size() ? 100.0 * top / file.size() : 100.0, viewer->hex() ? "HEX" : "TEXT",
+                     follow ? " FOLLOW" : "",
+                     indexed ? (std::to_string(viewer->lines().lineCount()) + " lines").c_str()
+                             : ("indexing " + std::to_string(file.size() ? 100 * viewer->lines().indexedBytes() /
+                                                                           file.size() : 100) + "%").c_str());
+            renderer.addLine(status);
+            if (promptKind) {
+                renderer.addLine(std::string(promptKind == ':' ? "Go to line: " : "Go to offset: ") + prompt);
+            } else if (!message.empty()) {
+                renderer.addLine(message);
+            } else {
+                renderer.addLine("↑/↓ PgUp/PgDn g/G  : line  o offset  x hex  f follow  q back");
+            }
+            renderer.present();
+            
+            struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {watchFd, POLLIN, 0}};
+            int timeout = (!indexed || waitingForLine) ? 250 : -1;
+            if (poll(fds, watchFd >= 0 ? 2 : 1, timeout) <= 0) continue;
+            if (watchFd >= 0 && (fds[1].revents & POLLIN)) {
+                char events[4096];
+                while (read(watchFd, events, sizeof(events)) > 0) {}
+            }
+            if (!(fds[0].revents & POLLIN)) continue;
+            
+            int key = terminal.readKey();
+            if (key == RawTerminal::Eof) break;
+            if (promptKind) {
+                if (key == RawTerminal::Escape) {
+                    promptKind = 0;
+                } else if (key == RawTerminal::Backspace) {
+                    if (!prompt.empty()) prompt.pop_back();
+                } else if (key == RawTerminal::Enter) {
+                    char* end = nullptr;
+                    uint64_t value = std::strtoull(prompt.c_str(), &end, 0);
+                    if (promptKind == ':') {
+                        pendingLine = value > 0 ? value - 1 : 0;
+                        waitingForLine = !viewer->offsetOfLine(pendingLine, top);
+                        message = waitingForLine ? "Waiting for the line index to reach line " + prompt + "..." : "";
+                    } else {
+                        if (end && *end == '%') value = static_cast<uint64_t>(file.size() * std::min(100.0, std::strtod(prompt.c_str(), nullptr)) / 100);
+                        top = viewer->lineStart(std::min(value, file.size()));
+                    }
+                    follow = false;
+                    promptKind = 0;
+                } else if (key >= 32 && key < 127) {
+                    prompt += static_cast<char>(key);
+                }
+                continue;
+            }
+            waitingForLine = false;
+            message.clear();
+            if (key == 'q' || key == 'Q' || key == RawTerminal::Escape) break;
+            switch (key) {
+                case RawTerminal::Down: case 'j':
+                    if (viewer->nextRow(top) < file.size()) top = viewer->nextRow(top);
+                    break;
+                case RawTerminal::Up: case 'k':
+                    top = viewer->previousRow(top);
+                    follow = false;
+                    break;
+                case RawTerminal::PageDown: case ' ':
+                    for (size_t i = 0; i < rows && viewer->nextRow(top) < file.size(); i++) top = viewer->nextRow(top);
+                    break;
+                case RawTerminal::PageUp: case 'b':
+                    for (size_t i = 0; i < rows && top > 0; i++) top = viewer->previousRow(top);
+                    follow = false;
+                    break;
+                case RawTerminal::Home: case 'g':
+                    top = 0;
+                    follow = false;
+                    break;
+                case RawTerminal::End: case 'G':
+                    top = viewer->lastPage(rows);
+                    break;
+                case 'x': case 'X':
+                    viewer->setHex(!viewer->hex());
+                    top = viewer->lineStart(top);
+                    break;
+                case 'f': case 'F':
+                    follow = !follow;
+                    if (follow) top = viewer->lastPage(rows);
+                    break;
+                case ':': case 'o': case 'O':
+                    promptKind = key == ':' ? ':' : 'o';
+                    prompt.clear();
+                    break;
+            }
+        }
+        if (watchFd >= 0) close(watchFd);
+        renderer.finish();
+    }
+
+    int getValidMenuChoice() {
+        int choice;
+        while (true) {
+            if (std::cin >> choice) {
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                return choice;
+            } else {
+                std::cin.clear();
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                std::cout << "\nInvalid input! Please enter a number: ";
+            }
+        }
+    }
+
+    void run() {
+        int choice;
+        if (isatty(STDOUT_FILENO)) setvbuf(stdout, nullptr, _IOFBF, 64 * 1024);
+        offerResume();
+        
+        while (true) {
+            clearScreen();
+            displayHeader();
+            displayMenu();
+            
+            choice = getValidMenuChoice();
+            
+            switch (choice) {
+                case 1:
+                    listFiles();
+                    break;
+                case 2:
+                    changeDirectory();
+                    break;
+                case 3:
+                    createFile();
+                    break;
+                case 4:
+                    createDirectory();
+                    break;
+                case 5:
+                    copyFile();
+                    break;
+                case 6:
+                    moveFile();
+                    break;
+                case 7:
+                    deleteFile();
+                    break;
+                case 8:
+                    deleteDirectory();
+                    break;
+                case 9:
+                    searchFiles();
+                    break;
+                case 10:
+                    viewPermissions();
+                    break;
+                case 11:
+                    changePermissions();
+                    break;
+                case 12:
+                    viewFileDetails();
+                    break;
+                case 13:
+                    buildIndex();
+                    break;
+                case 14:
+                    searchContents();
+                    break;
+                case 15:
+                    analyzeDiskUsage();
+                    break;
+                case 16:
+                    findDuplicates();
+                    break;
+                case 17:
+                    manageInstrumentation();
+                    break;
+                case 18:
+                    bulkChangePermissions();
+                    break;
+                case 19:
+                    manageSelection();
+                    break;
+                case 20:
+                    querySearch();
+                    break;
+                case 21:
+                    manageSnapshots();
+                    break;
+                case 22:
+                    manageArchives();
+                    break;
+                case 23:
+                    fuzzyFind();
+                    break;
+                case 24:
+                    viewFileContents();
+                    break;
+                case 0:
+                    clearScreen();
+                    std::cout << "\n╔═══════════════════════════════════════════════╗\n";
+                    std::cout << "║  Thank you for using File Explorer!           ║\n";
+                    std::cout << "║  Goodbye!                                      ║\n";
+                    std::cout << "╚═══════════════════════════════════════════════╝\n\n";
+                    return;
+                default:
+                    std::cout << "\nInvalid choice! Please try again.\n";
+                    std::cout << "Press Enter to continue...";
+                    std::cin.get();
+            }
+        }
+    }
+};
+
+class OutputWriter {
+public:
+    explicit OutputWriter(int fd = STDOUT_FILENO, size_t capacity = 256 * 1024) : fd(fd), capacity(capacity) {
+        buffer.reserve(capacity);
+    }
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+    ~OutputWriter() { flush(); }
+
+    void write(std::string_view data) {
+        if (buffer.size() + data.size() > capacity) flush();
+        if (data.size() >= capacity) {
+            writeAll(data);
+        } else {
+            buffer.append(data);
+        }
+    }
+
+    void write(char c) {
+        if (buffer.size() + 1 > capacity) flush();
+        buffer.push_back(c);
+    }
+
+    void flush() {
+        writeAll(buffer);
+        buffer.clear();
+    }
+
+private:
+    int fd;
+    size_t capacity;
+    std::string buffer;
+
+    void writeAll(std::string_view data) {
+        while (!data.empty()) {
+            ssize_t written = ::write(fd, data.data(), data.size());
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            data.remove_prefix(static_cast<size_t>(written));
+        }
+    }
+};
+
+enum class RecordFormat { Text, Ndjson, Nul };
+
+class RecordWriter {
+public:
+    RecordWriter(OutputWriter& out, RecordFormat format) : out(out), format(format) {}
+
+    RecordWriter& field(std::string_view key, std::string_view value) {
+        separate(key);
+        if (format == RecordFormat::Ndjson) {
+            appendJsonString(value);
+        } else if (format == RecordFormat::Text || fieldCount == 1) {
+            record.append(value);
+        }
+        return *this;
+    }
+
+    RecordWriter& field(std::string_view key, const char* value) {
+        return field(key, std::string_view(value));
+    }
+
+    RecordWriter& field(std::string_view key, uintmax_t value) {
+        separate(key);
+        if (format != RecordFormat::Nul || fieldCount == 1) record += std::to_string(value);
+        return *this;
+    }
+
+    RecordWriter& field(std::string_view key, bool value) {
+        separate(key);
+        if (format != RecordFormat::Nul || fieldCount == 1) record += value ? "true" : "false";
+        return *this;
+    }
+
+    void end() {
+        if (format == RecordFormat::Ndjson) record += '}';
+        record += format == RecordFormat::Nul ? '\0' : '\n';
+        std::lock_guard<std::mutex> guard(lock);
+        out.write(record);
+        record.clear();
+        fieldCount = 0;
+    }
+
+private:
+    OutputWriter& out;
+    RecordFormat format;
+    std::string record;
+    size_t fieldCount = 0;
+    static inline std::mutex lock;
+
+    void separate(std::string_view key) {
+        fieldCount++;
+        if (format == RecordFormat::Ndjson) {
+            record += fieldCount == 1 ? '{' : ',';
+            appendJsonString(key);
+            record += ':';
+        } else if (format == RecordFormat::Text && fieldCount > 1) {
+            record += '\t';
+        }
+    }
+
+    void appendJsonString(std::string_view value) {
+        record += '"';
+        for (unsigned char c : value) {
+            switch (c) {
+                case '"': record += "\\\""; break;
+                case '\\': record += "\\\\"; break;
+                case '\n': record += "\\n"; break;
+                case '\r': record += "\\r"; break;
+                case '\t': record += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        record += escaped;
+                    } else {
+                        record += static_cast<char>(c);
+                    }
+            }
+        }
+        record += '"';
+    }
+};
+
+class CommandRunner {
+public:
+    explicit CommandRunner(RecordFormat format) : format(format) {}
+
+    static int main(int argc, char* argv[]) {
+        RecordFormat format = RecordFormat::Text;
+        bool printStats = false;
+        std::string traceFile;
+        std::vector<std::string> args;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--format=ndjson" || arg == "--json") {
+                format = RecordFormat::Ndjson;
+            } else if (arg == "--format=nul" || arg == "-0") {
+                format = RecordFormat::Nul;
+            } else if (arg == "--format=text") {
+                format = RecordFormat::Text;
+            } else if (arg == "--stats") {
+                printStats = true;
+            } else if (arg.rfind("--trace=", 0) == 0) {
+                traceFile = arg.substr(8);
             } else {
-                fs::rename(sourcePath, destPath);
-                std::cout << "\nFile moved successfully!\n";
-                std::cout << "From: " << sourcePath << "\n";
-                std::cout << "To:   " << destPath << "\n";
+                args.push_back(arg);
             }
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError: " << e.what() << "\n";
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
+        if (printStats || !traceFile.empty()) Instrumentation::setEnabled(true);
+        int status;
+        {
+            CommandRunner runner(format);
+            status = runner.execute(args);
+        }
+        if (printStats) std::cerr << Instrumentation::summary();
+        if (!traceFile.empty() && !Instrumentation::exportChromeTrace(traceFile)) {
+            std::cerr << "file_explorer: cannot write trace " << traceFile << "\n";
+            status = status == 0 ? 1 : status;
+        }
+        return status;
     }
 
-    void deleteFile() {
-        clearScreen();
-        displayHeader();
-        std::cout << "Delete File\n";
-        std::cout << "───────────\n\n";
-        
-        std::string fileName;
-        
-        std::cout << "Enter file name to delete: ";
-        std::getline(std::cin, fileName);
-        
+    int execute(const std::vector<std::string>& args) {
+        if (args.empty()) return usage();
+        const std::string& command = args[0];
         try {
-            fs::path filePath = currentPath / fileName;
-            
-            if (!fs::exists(filePath)) {
-                std::cout << "\nError: File does not exist!\n";
-            } else if (fs::is_directory(filePath)) {
-                std::cout << "\nError: This is a directory. Use 'Delete Directory' option.\n";
+            if (command == "ls") return list(args.size() > 1 ? args[1] : ".");
+            if (command == "find" && args.size() >= 2) return find(args);
+            if (command == "grep" && args.size() >= 2) return grep(args);
+            if (command == "query" && args.size() >= 2) return query(args);
+            if (command == "cp" && args.size() == 3) return copy(args[1], args[2]);
+            if (command == "mv" && args.size() == 3) return move(args[1], args[2]);
+            if (command == "rm" && args.size() == 2) return remove(args[1]);
+            if (command == "stat" && args.size() >= 2) return stat(args);
+            if (command == "batch" && args.size() == 2) return batch(args[1]);
+            if (command == "snapshot" && (args.size() == 3 || args.size() == 4)) return snapshot(args);
+            if (command == "diff" && (args.size() == 2 || args.size() == 3)) return diff(args);
+            if (command == "export" && (args.size() == 3 || args.size() == 4)) return exportArchive(args);
+            if (command == "import" && (args.size() == 2 || args.size() == 3)) return importArchive(args);
+            if (command == "jobs" && args.size() == 1) return jobs();
+            if (command == "fuzzy" && (args.size() == 2 || args.size() == 3)) return fuzzy(args);
+            if (command == "view" && args.size() >= 2) return view(args);
+            if (command == "resume" && args.size() == 2) return resume(args[1]);
+        } catch (const fs::filesystem_error& e) {
+            output.flush();
+            std::cerr << "file_explorer: " << e.what() << "\n";
+            return 1;
+        } catch (const std::regex_error& e) {
+            std::cerr << "file_explorer: invalid regular expression: " << e.what() << "\n";
+            return 2;
+        }
+        return usage();
+    }
+
+private:
+    RecordFormat format;
+    OutputWriter output;
+
+    static int usage() {
+        std::cerr << "Usage: file_explorer [--format=text|ndjson|nul] [--stats] [--trace=FILE] COMMAND [ARGS]\n"
+                     "  ls [DIR]                             list a directory\n"
+                     "  find [DIR] PATTERN [--mode=MODE]     search names (substring, icase, glob, regex)\n"
+                     "  grep [DIR] TEXT                      search file contents\n"
+                     "  query [DIR] TERMS...                 filter by name, size, mtime, type, perm, depth\n"
+                     "  cp SOURCE DEST                       copy a file or directory tree\n"
+                     "  mv SOURCE DEST                       move a file or directory tree\n"
+                     "  rm PATH                              delete a file or directory tree\n"
+                     "  stat PATH...                         show metadata\n"
+                     "  batch FILE                           run one command per line ('-' for stdin)\n"
+                     "  snapshot DIR FILE [--hash]           record a tree snapshot (reuses FILE if present)\n"
+                     "  diff SNAPSHOT [SNAPSHOT2|DIR]        compare a snapshot with another or the live tree\n"
+                     "  export DIR ARCHIVE [--gzip]          write a tar archive ('-' for stdout, .gz/.tgz compress)\n"
+                     "  import ARCHIVE [DIR]                 extract a tar or tar.gz archive ('-' for stdin)\n"
+                     "  fuzzy [DIR] QUERY                    rank paths by fuzzy match (best first)\n"
+                     "  view FILE [--hex] [--line=N]          print a page of a file (--offset=X, --rows=N)\n"
+                     "  jobs                                 list interrupted copy/move/delete jobs\n"
+                     "  resume ID                            resume an interrupted job\n";
+        return 2;
+    }
+
+    static const char* typeName(const EntryStat& st) {
+        if (st.isDirectory()) return "dir";
+        if (st.isRegular()) return "file";
+        if (S_ISLNK(st.mode)) return "symlink";
+        return "other";
+    }
+
+    static const char* typeName(unsigned char type) {
+        switch (type) {
+            case DT_DIR: return "dir";
+            case DT_REG: return "file";
+            case DT_LNK: return "symlink";
+            default: return "other";
+        }
+    }
+
+    void writeStat(const std::string& path, const EntryStat& st) {
+        char mode[8];
+        snprintf(mode, sizeof(mode), "%04o", st.mode & 07777);
+        RecordWriter(output, format)
+            .field("path", path)
+            .field("type", typeName(st))
+            .field("size", static_cast<uintmax_t>(st.size))
+            .field("mode", mode)
+            .field("mtime", static_cast<uintmax_t>(st.modifiedSeconds()))
+            .end();
+    }
+
+    int list(const fs::path& dir) {
+        MetadataCache metadata;
+        auto table = metadata.listDirectory(dir);
+        for (size_t i = 0; i < table->size(); i++) {
+            writeStat((dir / std::string(table->name(i))).string(), table->stat(i));
+        }
+        return 0;
+    }
+
+    int stat(const std::vector<std::string>& args) {
+        int status = 0;
+        for (size_t i = 1; i < args.size(); i++) {
+            EntryStat st;
+            if (statEntry(AT_FDCWD, args[i].c_str(), st)) {
+                writeStat(args[i], st);
             } else {
-                std::cout << "\nAre you sure you want to delete '" << fileName << "'? (y/n): ";
-                char confirm;
-                std::cin >> confirm;
-                
-                if (confirm == 'y' || confirm == 'Y') {
-                    fs::remove(filePath);
-                    std::cout << "\nFile deleted successfully!\n";
-                } else {
-                    std::cout << "\nDeletion cancelled.\n";
+                output.flush();
+                std::cerr << "file_explorer: " << args[i] << ": " << std::strerror(errno) << "\n";
+                status = 1;
+            }
+        }
+        return status;
+    }
+
+    int find(const std::vector<std::string>& args) {
+        std::vector<std::string> positional;
+        MatchMode mode = MatchMode::Substring;
+        for (size_t i = 1; i < args.size(); i++) {
+            if (args[i] == "--mode=icase") mode = MatchMode::IgnoreCase;
+            else if (args[i] == "--mode=glob") mode = MatchMode::Glob;
+            else if (args[i] == "--mode=regex") mode = MatchMode::Regex;
+            else if (args[i] == "--mode=substring") mode = MatchMode::Substring;
+            else positional.push_back(args[i]);
+        }
+        if (positional.empty()) return usage();
+        fs::path root = positional.size() > 1 ? positional[0] : ".";
+        NameMatcher matcher(positional.back(), mode);
+
+        ParallelWalker walker;
+        walker.walk(root, [&](const WalkEntry& entry) {
+            if (matcher.matches(entry.name)) {
+                RecordWriter(output, format).field("path", entry.path).field("type", typeName(entry.type)).end();
+            }
+            return true;
+        });
+        return 0;
+    }
+
+    int query(const std::vector<std::string>& args) {
+        size_t first = 1;
+        fs::path root = ".";
+        std::error_code ec;
+        if (args.size() > 2 && fs::is_directory(args[1], ec)) {
+            root = args[1];
+            first = 2;
+        }
+        std::string text;
+        for (size_t i = first; i < args.size(); i++) text += args[i] + " ";
+        try {
+            FileQuery query(text);
+            QueryStats stats;
+            query.run(root, stats, [&](const QueryMatch& match) {
+                RecordWriter record(output, format);
+                record.field("path", match.path).field("type", typeName(match.type));
+                if (query.sorted()) {
+                    record.field("size", static_cast<uintmax_t>(match.size))
+                          .field("mtime", static_cast<uintmax_t>(match.mtime));
+                }
+                record.end();
+            });
+            return stats.matches > 0 ? 0 : 1;
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "file_explorer: " << e.what() << "\n";
+            return 2;
+        }
+    }
+
+    int grep(const std::vector<std::string>& args) {
+        fs::path root = args.size() > 2 ? args[1] : ".";
+        ContentSearchStats stats;
+        ContentSearcher::search(root, args.back(), stats,
+            [&](const std::string& path, const std::vector<ContentMatch>& matches) {
+                for (const auto& match : matches) {
+                    RecordWriter(output, format)
+                        .field("path", path)
+                        .field("line", static_cast<uintmax_t>(match.line))
+                        .field("text", match.text)
+                        .end();
                 }
+            });
+        return stats.matches > 0 ? 0 : 1;
+    }
+
+    int writeResult(const char* op, const std::string& from, const std::string& to, const TreeCopyStats& stats) {
+        RecordWriter(output, format)
+            .field("op", op)
+            .field("from", from)
+            .field("to", to)
+            .field("files", stats.files.load())
+            .field("bytes", stats.bytes.load())
+            .field("resumed", stats.resumed.load())
+            .field("ok", stats.errors.empty() && !stats.interrupted)
+            .end();
+        for (const auto& error : stats.errors) {
+            std::cerr << "file_explorer: " << error << "\n";
+        }
+        if (stats.interrupted) {
+            output.flush();
+            std::cerr << "file_explorer: interrupted, run the same command again to resume\n";
+            return 130;
+        }
+        return stats.errors.empty() ? 0 : 1;
+    }
+
+    int fuzzy(const std::vector<std::string>& args) {
+        fs::path root = args.size() == 3 ? args[1] : ".";
+        FuzzyCandidates candidates;
+        FileIndex index;
+        if (index.load(fs::absolute(root).lexically_normal()) && index.isFresh()) {
+            candidates.loadFromIndex(index);
+        } else {
+            candidates.loadFromWalk(root);
+        }
+        FuzzyFinder finder(candidates);
+        finder.setQuery(args.back());
+        for (const auto& result : finder.results()) {
+            RecordWriter(output, format)
+                .field("path", (root / std::string(candidates.path(result.index))).string())
+                .field("score", static_cast<uintmax_t>(std::max(0, result.score)))
+                .end();
+        }
+        return finder.matchCount() > 0 ? 0 : 1;
+    }
+
+    int view(const std::vector<std::string>& args) {
+        FileViewer viewer(args[1]);
+        uint64_t line = 0;
+        uint64_t offset = 0;
+        bool byLine = false;
+        size_t rows = 40;
+        for (size_t i = 2; i < args.size(); i++) {
+            if (args[i] == "--hex") {
+                viewer.setHex(true);
+            } else if (args[i] == "--text") {
+                viewer.setHex(false);
+            } else if (args[i].rfind("--line=", 0) == 0) {
+                line = std::strtoull(args[i].c_str() + 7, nullptr, 10);
+                byLine = true;
+            } else if (args[i].rfind("--offset=", 0) == 0) {
+                offset = std::strtoull(args[i].c_str() + 9, nullptr, 0);
+            } else if (args[i].rfind("--rows=", 0) == 0) {
+                rows = static_cast<size_t>(std::strtoull(args[i].c_str() + 7, nullptr, 10));
+            } else {
+                return usage();
             }
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError: " << e.what() << "\n";
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.ignore();
-        std::cin.get();
+        if (byLine) {
+            while (!viewer.offsetOfLine(line > 0 ? line - 1 : 0, offset)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                viewer.refresh();
+            }
+        }
+        uint64_t top = viewer.lineStart(std::min(offset, viewer.source().size()));
+        if (top >= viewer.source().size()) top = viewer.lastPage(rows);
+        for (const auto& text : viewer.page(top, rows, 4096)) {
+            RecordWriter(output, format).field("offset", static_cast<uintmax_t>(top)).field("text", text).end();
+            top = viewer.nextRow(top);
+        }
+        return 0;
     }
 
-    void deleteDirectory() {
-        clearScreen();
-        displayHeader();
-        std::cout << "Delete Directory\n";
-        std::cout << "────────────────\n\n";
-        
-        std::string dirName;
-        
-        std::cout << "Enter directory name to delete: ";
-        std::getline(std::cin, dirName);
-        
+    int jobs() {
+        for (const auto& job : JobJournal::pending()) {
+            RecordWriter(output, format)
+                .field("id", job.id)
+                .field("op", JobJournal::kindName(job.kind))
+                .field("from", job.source)
+                .field("to", job.target)
+                .field("completed", static_cast<uintmax_t>(job.completed))
+                .end();
+        }
+        return 0;
+    }
+
+    int resume(const std::string& id) {
+        for (const auto& job : JobJournal::pending()) {
+            if (job.id != id) continue;
+            switch (job.kind) {
+                case JobKind::Copy: return copy(job.source, job.target);
+                case JobKind::Move: return move(job.source, job.target);
+                case JobKind::Delete: return remove(job.source);
+            }
+        }
+        std::cerr << "file_explorer: no interrupted job with id " << id << "\n";
+        return 1;
+    }
+
+    int copy(const std::string& from, const std::string& to) {
+        TreeCopyStats stats;
+        if (fs::is_directory(from)) {
+            JobRunner::copy(from, to, stats);
+        } else {
+            CopyResult result = CopyEngine::copyFileAtomic(from, to);
+            stats.files = 1;
+            stats.bytes = result.bytes;
+        }
+        return writeResult("cp", from, to, stats);
+    }
+
+    int move(const std::string& from, const std::string& to) {
+        TreeCopyStats stats;
+        JobRunner::move(from, to, stats);
+        return writeResult("mv", from, to, stats);
+    }
+
+    int remove(const std::string& path) {
+        DeleteStats stats;
+        if (fs::is_directory(fs::symlink_status(path))) {
+            JobRunner::remove(path, stats);
+        } else if (unlink(path.c_str()) == 0) {
+            stats.entries = 1;
+        } else {
+            stats.failures.push_back(path + ": " + std::strerror(errno));
+        }
+        RecordWriter(output, format)
+            .field("op", "rm")
+            .field("path", path)
+            .field("entries", stats.entries.load())
+            .field("ok", stats.failures.empty() && !stats.interrupted)
+            .end();
+        for (const auto& failure : stats.failures) {
+            std::cerr << "file_explorer: " << failure << "\n";
+        }
+        if (stats.interrupted) {
+            output.flush();
+            std::cerr << "file_explorer: interrupted, run the same command again to resume\n";
+            return 130;
+        }
+        return stats.failures.empty() ? 0 : 1;
+    }
+
+    static std::vector<std::string> tokenize(const std::string& line) {
+        std::vector<std::string> tokens;
+        std::string current;
+        bool inToken = false;
+        char quote = 0;
+        for (char c : line) {
+            if (quote) {
+                if (c == quote) quote = 0;
+                else current += c;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+                inToken = true;
+            } else if (c == ' ' || c == '\t') {
+                if (inToken) tokens.push_back(std::move(current));
+                current.clear();
+                inToken = false;
+            } else {
+                current += c;
+                inToken = true;
+            }
+        }
+        if (inToken) tokens.push_back(std::move(current));
+        return tokens;
+    }
+
+    int snapshot(const std::vector<std::string>& args) {
+        bool hashes = args.size() == 4 && args[3] == "--hash";
+        if (args.size() == 4 && !hashes) return usage();
+        fs::path root = fs::absolute(args[1]).lexically_normal();
+        std::vector<SnapshotEntry> previous;
+        std::error_code ec;
+        if (fs::exists(args[2], ec)) {
+            std::string previousRoot;
+            bool previousHashes;
+            previous = SnapshotFile::load(args[2], previousRoot, previousHashes);
+            if (previousRoot != root.string()) previous.clear();
+        }
+        CaptureStats stats;
+        auto entries = TreeSnapshot::capture(root, previous.empty() ? nullptr : &previous, hashes, stats);
+        SnapshotFile::save(args[2], root.string(), entries, hashes);
+        RecordWriter(output, format)
+            .field("snapshot", args[2])
+            .field("root", root.string())
+            .field("entries", stats.entries)
+            .field("dirs_read", stats.directoriesRead)
+            .field("dirs_reused", stats.directoriesReused)
+            .field("hashed", stats.filesHashed.load())
+            .end();
+        return 0;
+    }
+
+    int diff(const std::vector<std::string>& args) {
+        SnapshotFile::Reader before(args[1]);
+        DiffStats stats;
+        std::vector<TreeChange> changes;
+        std::error_code ec;
+        if (args.size() == 3 && !fs::is_directory(args[2], ec)) {
+            SnapshotFile::Reader after(args[2]);
+            changes = TreeDiff::diff([&](SnapshotEntry& e) { return before.next(e); },
+                                     [&](SnapshotEntry& e) { return after.next(e); }, stats);
+        } else {
+            fs::path root = args.size() == 3 ? fs::absolute(args[2]).lexically_normal() : fs::path(before.root());
+            std::string previousRoot;
+            bool previousHashes;
+            auto previous = SnapshotFile::load(args[1], previousRoot, previousHashes);
+            CaptureStats captured;
+            auto live = TreeSnapshot::capture(root, previousRoot == root.string() ? &previous : nullptr,
+                                              previousHashes, captured);
+            changes = TreeDiff::diff(TreeDiff::fromVector(previous), TreeDiff::fromVector(live), stats);
+        }
+        for (const auto& change : changes) {
+            RecordWriter record(output, format);
+            record.field("change", std::string(1, TreeDiff::marker(change.kind)))
+                  .field("path", change.path)
+                  .field("type", typeName(change.type));
+            if (change.kind == ChangeKind::Renamed) record.field("from", change.from);
+            if (!change.detail.empty()) record.field("detail", change.detail);
+            record.end();
+        }
+        return changes.empty() ? 0 : 1;
+    }
+
+    void writeArchiveStats(const std::string& archive, const ArchiveStats& stats) {
+        RecordWriter(output, format)
+            .field("archive", archive)
+            .field("files", stats.files.load())
+            .field("dirs", stats.directories.load())
+            .field("symlinks", stats.symlinks.load())
+            .field("bytes", stats.bytes.load())
+            .field("archive_bytes", stats.archiveBytes)
+            .field("skipped", stats.skipped)
+            .field("errors", static_cast<uintmax_t>(stats.errors.size()))
+            .end();
+        output.flush();
+        for (const auto& error : stats.errors) std::cerr << "file_explorer: " << error << "\n";
+    }
+
+    int exportArchive(const std::vector<std::string>& args) {
+        bool gzip = args.size() == 4 && args[3] == "--gzip";
+        if (args.size() == 4 && !gzip) return usage();
+        bool toStdout = args[2] == "-";
+        gzip = gzip || TarArchive::wantsCompression(args[2]);
+        int fd = toStdout ? STDOUT_FILENO : open(args[2].c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw fs::filesystem_error("cannot create archive", args[2], std::error_code(errno, std::generic_category()));
+        }
+        ArchiveStats stats;
         try {
-            fs::path dirPath = currentPath / dirName;
-            
-            if (!fs::exists(dirPath)) {
-                std::cout << "\nError: Directory does not exist!\n";
-            } else if (!fs::is_directory(dirPath)) {
-                std::cout << "\nError: This is a file. Use 'Delete File' option.\n";
+            TarArchive::create(args[1], fd, gzip, stats);
+        } catch (...) {
+            if (!toStdout) close(fd);
+            throw;
+        }
+        if (!toStdout && close(fd) != 0) {
+            throw fs::filesystem_error("cannot write archive", args[2], std::error_code(errno, std::generic_category()));
+        }
+        if (!toStdout) writeArchiveStats(args[2], stats);
+        return stats.errors.empty() ? 0 : 1;
+    }
+
+    int importArchive(const std::vector<std::string>& args) {
+        bool fromStdin = args[1] == "-";
+        int fd = fromStdin ? STDIN_FILENO : open(args[1].c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw fs::filesystem_error("cannot open archive", args[1], std::error_code(errno, std::generic_category()));
+        }
+        ArchiveStats stats;
+        try {
+            TarArchive::extract(fd, args.size() == 3 ? args[2] : ".", stats);
+        } catch (...) {
+            if (!fromStdin) close(fd);
+            throw;
+        }
+        if (!fromStdin) close(fd);
+        writeArchiveStats(args[1], stats);
+        return stats.errors.empty() ? 0 : 1;
+    }
+
+    int batch(const std::string& file) {
+        std::ifstream stream;
+        std::istream* input = &std::cin;
+        if (file != "-") {
+            stream.open(file);
+            if (!stream) {
+                std::cerr << "file_explorer: cannot open " << file << "\n";
+                return 1;
+            }
+            input = &stream;
+        }
+        int status = 0;
+        std::string line;
+        while (std::getline(*input, line)) {
+            auto tokens = tokenize(line);
+            if (tokens.empty() || tokens[0][0] == '#') continue;
+            if (tokens[0] == "batch") {
+                std::cerr << "file_explorer: nested batch ignored\n";
+                continue;
+            }
+            if (execute(tokens) != 0) status = 1;
+        }
+        return status;
+    }
+};
+
+class BenchmarkSuite {
+public:
+    static int main(int argc, char* argv[]) {
+        BenchmarkSuite suite;
+        fs::path output;
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            bool valid = true;
+            if (arg.rfind("--runs=", 0) == 0) {
+                valid = parseCount(arg.substr(7), suite.runs);
+            } else if (arg.rfind("--scale=", 0) == 0) {
+                valid = parseCount(arg.substr(8), suite.scale);
+            } else if (arg.rfind("--dir=", 0) == 0) {
+                suite.baseDir = arg.substr(6);
+            } else if (arg.rfind("--output=", 0) == 0) {
+                output = arg.substr(9);
+            } else {
+                valid = false;
+            }
+            if (!valid) {
+                std::cerr << "usage: file_explorer bench [--runs=N] [--scale=N] [--dir=PATH] [--output=FILE]\n";
+                return 2;
+            }
+        }
+        try {
+            std::string json = suite.run();
+            if (output.empty()) {
+                std::cout << json;
             } else {
-                std::cout << "\nAre you sure you want to delete '" << dirName << "' and all its contents? (y/n): ";
-                char confirm;
-                std::cin >> confirm;
-                
-                if (confirm == 'y' || confirm == 'Y') {
-                    fs::remove_all(dirPath);
-                    std::cout << "\nDirectory deleted successfully!\n";
-                } else {
-                    std::cout << "\nDeletion cancelled.\n";
+                std::ofstream file(output);
+                file << json;
+                file.close();
+                if (!file) {
+                    std::cerr << "file_explorer: cannot write " << output << "\n";
+                    return 1;
                 }
+                std::cerr << "Wrote " << output << "\n";
             }
         } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError: " << e.what() << "\n";
+            std::cerr << "file_explorer: " << e.what() << "\n";
+            return 1;
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.ignore();
-        std::cin.get();
+        return 0;
     }
 
-    void searchFiles() {
-        clearScreen();
-        displayHeader();
-        std::cout << "Search Files\n";
-        std::cout << "────────────\n\n";
-        
-        std::string searchTerm;
-        
-        std::cout << "Enter file name to search: ";
-        std::getline(std::cin, searchTerm);
-        
-        std::cout << "\nSearching in: " << currentPath << "\n";
-        std::cout << "────────────────────────────────────────────────────────────────\n\n";
-        
-        int count = 0;
+private:
+    struct Tree {
+        std::string name;
+        fs::path root;
+        std::vector<fs::path> directories;
+        uintmax_t files = 0;
+        uintmax_t bytes = 0;
+    };
+
+    struct IoCounters {
+        uintmax_t syscr = 0;
+        uintmax_t syscw = 0;
+    };
+
+    struct Sample {
+        double seconds;
+        IoCounters io;
+    };
+
+    struct Measurement {
+        std::vector<Sample> samples;
+        uintmax_t syscalls = 0;
+    };
+
+    int runs = 5;
+    int scale = 1;
+    fs::path baseDir = fs::temp_directory_path();
+    fs::path workDir;
+    std::string cacheDropMethod;
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+    static bool parseCount(const std::string& text, int& out) {
+        char* end = nullptr;
+        errno = 0;
+        long value = std::strtol(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0' || errno == ERANGE || value < 1 || value > std::numeric_limits<int>::max()) {
+            return false;
+        }
+        out = static_cast<int>(value);
+        return true;
+    }
+
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    std::string run() {
+        workDir = baseDir / ("file_explorer-bench-" + std::to_string(getpid()));
+        fs::create_directories(workDir);
+        std::string json;
         try {
-            for (const auto& entry : fs::recursive_directory_iterator(currentPath)) {
-                std::string fileName = entry.path().filename().string();
-                if (fileName.find(searchTerm) != std::string::npos) {
-                    std::string type = entry.is_directory() ? "[DIR]" : "[FILE]";
-                    std::cout << type << " " << entry.path() << "\n";
-                    count++;
-                }
+            std::vector<Tree> trees;
+            trees.push_back(generateWide());
+            trees.push_back(generateDeep());
+            trees.push_back(generateTiny());
+            trees.push_back(generateHuge());
+
+            std::string results;
+            for (const auto& tree : trees) {
+                if (!results.empty()) results += ",\n";
+                results += benchTree(tree);
             }
-            
-            if (count == 0) {
-                std::cout << "No files found matching '" << searchTerm << "'\n";
-            } else {
-                std::cout << "\n────────────────────────────────────────────────────────────────\n";
-                std::cout << "Found " << count << " item(s) matching '" << searchTerm << "'\n";
+            results += "\n  ],\n  \"copy_methods\": [\n" + benchCopyMethods(trees.back());
+            results += "\n  ],\n  \"matchers\": [\n" + benchMatchers();
+            results += "\n  ],\n  \"fuzzy\": [\n" + benchFuzzy();
+            char header[256];
+            snprintf(header, sizeof(header),
+                     "{\n  \"version\": 1,\n  \"timestamp\": %lld,\n  \"runs\": %d,\n  \"scale\": %d,\n"
+                     "  \"threads\": %u,\n  \"cold_cache\": \"%s\",\n  \"trees\": [\n",
+                     static_cast<long long>(std::time(nullptr)), runs, scale,
+                     std::thread::hardware_concurrency(), cacheDropMethod.c_str());
+            json = header + results + "\n  ]\n}\n";
+        } catch (...) {
+            std::error_code ec;
+            fs::remove_all(workDir, ec);
+            throw;
+        }
+        std::error_code ec;
+        fs::remove_all(workDir, ec);
+        return json;
+    }
+
+    void writeFile(Tree& tree, const fs::path& path, uintmax_t size) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        std::vector<char> block(std::min<uintmax_t>(size, 1024 * 1024));
+        for (uintmax_t written = 0; written < size && out;) {
+            for (size_t j = 0; j + 8 <= block.size(); j += 8) {
+                uint64_t value = next();
+                std::memcpy(block.data() + j, &value, 8);
             }
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError during search: " << e.what() << "\n";
+            size_t chunk = static_cast<size_t>(std::min<uintmax_t>(block.size(), size - written));
+            out.write(block.data(), static_cast<std::streamsize>(chunk));
+            written += chunk;
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
+        if (!out) {
+            throw fs::filesystem_error("cannot write benchmark file", path,
+                                       std::make_error_code(std::errc::io_error));
+        }
+        tree.files++;
+        tree.bytes += size;
     }
 
-    void viewPermissions() {
-        clearScreen();
-        displayHeader();
-        std::cout << "View File Permissions\n";
-        std::cout << "─────────────────────\n\n";
-        
-        std::string fileName;
-        
-        std::cout << "Enter file/directory name: ";
-        std::getline(std::cin, fileName);
-        
-        try {
-            fs::path filePath = currentPath / fileName;
-            
-            if (!fs::exists(filePath)) {
-                std::cout << "\nError: File/Directory does not exist!\n";
-            } else {
-                auto perms = fs::status(filePath).permissions();
-                struct stat fileStat;
-                stat(filePath.c_str(), &fileStat);
-                
-                std::cout << "\nFile: " << filePath << "\n";
-                std::cout << "────────────────────────────────────────────────────────────────\n";
-                std::cout << "Permissions: " << getPermissionString(perms) << "\n";
-                std::cout << "Octal:       " << std::oct << (fileStat.st_mode & 0777) << std::dec << "\n";
-                std::cout << "\nOwner:  Read=" << ((perms & fs::perms::owner_read) != fs::perms::none ? "Yes" : "No");
-                std::cout << " Write=" << ((perms & fs::perms::owner_write) != fs::perms::none ? "Yes" : "No");
-                std::cout << " Execute=" << ((perms & fs::perms::owner_exec) != fs::perms::none ? "Yes" : "No") << "\n";
-                std::cout << "Group:  Read=" << ((perms & fs::perms::group_read) != fs::perms::none ? "Yes" : "No");
-                std::cout << " Write=" << ((perms & fs::perms::group_write) != fs::perms::none ? "Yes" : "No");
-                std::cout << " Execute=" << ((perms & fs::perms::group_exec) != fs::perms::none ? "Yes" : "No") << "\n";
-                std::cout << "Others: Read=" << ((perms & fs::perms::others_read) != fs::perms::none ? "Yes" : "No");
-                std::cout << " Write=" << ((perms & fs::perms::others_write) != fs::perms::none ? "Yes" : "No");
-                std::cout << " Execute=" << ((perms & fs::perms::others_exec) != fs::perms::none ? "Yes" : "No") << "\n";
+    Tree makeTree(const std::string& name) {
+        Tree tree;
+        tree.name = name;
+        tree.root = workDir / name;
+        fs::create_directories(tree.root);
+        tree.directories.push_back(tree.root);
+        std::cerr << "Generating " << name << " tree...\n";
+        return tree;
+    }
+
+    Tree generateWide() {
+        Tree tree = makeTree("wide");
+        for (int i = 0; i < 20000 * scale; i++) {
+            writeFile(tree, tree.root / ("entry_" + std::to_string(next() % 1000000) + "_" + std::to_string(i) + ".dat"),
+                      next() % 256);
+        }
+        return tree;
+    }
+
+    Tree generateDeep() {
+        Tree tree = makeTree("deep");
+        fs::path dir = tree.root;
+        for (int depth = 0; depth < 200 * scale; depth++) {
+            dir /= "level_" + std::to_string(depth);
+            fs::create_directory(dir);
+            tree.directories.push_back(dir);
+            for (int i = 0; i < 4; i++) {
+                writeFile(tree, dir / ("file_" + std::to_string(i) + ".txt"), 512 + next() % 1024);
             }
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError: " << e.what() << "\n";
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
+        return tree;
     }
 
-    void changePermissions() {
-        clearScreen();
-        displayHeader();
-        std::cout << "Change File Permissions\n";
-        std::cout << "───────────────────────\n\n";
-        
-        std::string fileName;
-        
-        std::cout << "Enter file/directory name: ";
-        std::getline(std::cin, fileName);
-        
-        try {
-            fs::path filePath = currentPath / fileName;
-            
-            if (!fs::exists(filePath)) {
-                std::cout << "\nError: File/Directory does not exist!\n";
-            } else {
-                std::cout << "\nCurrent permissions: " << getPermissionString(fs::status(filePath).permissions()) << "\n";
-                std::cout << "\nEnter new permissions in octal format (e.g., 644, 755): ";
-                std::string octalPerms;
-                std::getline(std::cin, octalPerms);
-                
-                try {
-                    int perms = std::stoi(octalPerms, nullptr, 8);
-                    fs::permissions(filePath, static_cast<fs::perms>(perms), fs::perm_options::replace);
-                    std::cout << "\nPermissions changed successfully!\n";
-                    std::cout << "New permissions: " << getPermissionString(fs::status(filePath).permissions()) << "\n";
-                } catch (const std::exception& e) {
-                    std::cout << "\nError: Invalid permission format!\n";
-                }
+    Tree generateTiny() {
+        Tree tree = makeTree("tiny");
+        for (int d = 0; d < 100 * scale; d++) {
+            fs::path dir = tree.root / ("dir_" + std::to_string(d));
+            fs::create_directory(dir);
+            tree.directories.push_back(dir);
+            for (int i = 0; i < 200; i++) {
+                writeFile(tree, dir / ("small_" + std::to_string(i) + ".bin"), 1 + next() % 4096);
             }
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError: " << e.what() << "\n";
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
+        return tree;
     }
 
-    void viewFileDetails() {
-        clearScreen();
-        displayHeader();
-        std::cout << "View File Details\n";
-        std::cout << "─────────────────\n\n";
-        
-        std::string fileName;
-        
-        std::cout << "Enter file/directory name: ";
-        std::getline(std::cin, fileName);
-        
-        try {
-            fs::path filePath = currentPath / fileName;
-            
-            if (!fs::exists(filePath)) {
-                std::cout << "\nError: File/Directory does not exist!\n";
-            } else {
-                auto fileStatus = fs::status(filePath);
-                struct stat fileStat;
-                stat(filePath.c_str(), &fileStat);
-                
-                std::cout << "\n╔═══════════════════ FILE DETAILS ═══════════════════╗\n";
-                std::cout << "║ Name:        " << filePath.filename() << "\n";
-                std::cout << "║ Path:        " << fs::absolute(filePath) << "\n";
-                std::cout << "║ Type:        " << (fs::is_directory(filePath) ? "Directory" : "File") << "\n";
-                
-                if (fs::is_regular_file(filePath)) {
-                    std::cout << "║ Size:        " << formatFileSize(fs::file_size(filePath)) << "\n";
+    Tree generateHuge() {
+        Tree tree = makeTree("huge");
+        for (int i = 0; i < 4; i++) {
+            writeFile(tree, tree.root / ("huge_" + std::to_string(i) + ".bin"),
+                      static_cast<uintmax_t>(32) * 1024 * 1024 * scale);
+        }
+        return tree;
+    }
+
+    static IoCounters readIoCounters() {
+        IoCounters counters;
+        std::ifstream in("/proc/self/io");
+        std::string key;
+        uintmax_t value;
+        while (in >> key >> value) {
+            if (key == "syscr:") counters.syscr = value;
+            else if (key == "syscw:") counters.syscw = value;
+        }
+        return counters;
+    }
+
+    void dropCaches(const Tree& tree) {
+        sync();
+        {
+            std::ofstream drop("/proc/sys/vm/drop_caches");
+            if (drop << "3" << std::flush) {
+                cacheDropMethod = "drop_caches";
+                return;
+            }
+        }
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(tree.root, ec); !ec && it != fs::recursive_directory_iterator();
+             it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            int fd = open(it->path().c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) continue;
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+        cacheDropMethod = "fadvise";
+    }
+
+    template <typename Prepare, typename Operation>
+    Measurement measure(const Tree& tree, bool cold, Prepare prepare, Operation operation) {
+        IoCounters first = readIoCounters();
+        IoCounters second = readIoCounters();
+        IoCounters overhead{second.syscr - first.syscr, second.syscw - first.syscw};
+        Measurement measurement;
+        std::vector<Sample>& samples = measurement.samples;
+        prepare();
+        operation();
+        for (int i = 0; i < runs; i++) {
+            prepare();
+            if (cold) dropCaches(tree);
+            IoCounters before = readIoCounters();
+            auto start = std::chrono::steady_clock::now();
+            operation();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            IoCounters after = readIoCounters();
+            samples.push_back(Sample{seconds, {after.syscr - before.syscr - overhead.syscr,
+                                               after.syscw - before.syscw - overhead.syscw}});
+        }
+        prepare();
+        bool previous = Instrumentation::enabled();
+        Instrumentation::reset();
+        Instrumentation::setEnabled(true);
+        operation();
+        Instrumentation::setEnabled(previous);
+        measurement.syscalls = Instrumentation::total(Counter::Syscalls);
+        return measurement;
+    }
+
+    static std::string report(const char* operation, bool cold, Measurement measurement,
+                              uintmax_t entries, uintmax_t bytes) {
+        std::vector<Sample>& samples = measurement.samples;
+        std::sort(samples.begin(), samples.end(),
+            [](const Sample& a, const Sample& b) { return a.seconds < b.seconds; });
+        auto percentile = [&](double p) {
+            size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+            return samples[index].seconds;
+        };
+        double total = 0;
+        uintmax_t syscr = 0;
+        uintmax_t syscw = 0;
+        for (const auto& sample : samples) {
+            total += sample.seconds;
+            syscr += sample.io.syscr;
+            syscw += sample.io.syscw;
+        }
+        double p50 = percentile(0.50);
+        double mean = total / static_cast<double>(samples.size());
+        char line[512];
+        snprintf(line, sizeof(line),
+                 "        {\"op\": \"%s\", \"cache\": \"%s\", \"p50_ms\": %.3f, \"p99_ms\": %.3f, "
+                 "\"mean_ms\": %.3f, \"entries_per_s\": %.0f, \"mb_per_s\": %.1f, "
+                 "\"syscalls\": %ju, \"read_calls\": %ju, \"write_calls\": %ju}",
+                 operation, cold ? "cold" : "warm", p50 * 1e3, percentile(0.99) * 1e3, mean * 1e3,
+                 p50 > 0 ? static_cast<double>(entries) / p50 : 0.0,
+                 p50 > 0 ? static_cast<double>(bytes) / p50 / (1024.0 * 1024.0) : 0.0,
+                 measurement.syscalls, syscr / samples.size(), syscw / samples.size());
+        return line;
+    }
+
+    std::string benchTree(const Tree& tree) {
+        uintmax_t entries = tree.files + tree.directories.size();
+        fs::path copyTarget = workDir / (tree.name + ".copy");
+        auto nothing = [] {};
+        auto removeCopy = [&] {
+            std::error_code ec;
+            fs::remove_all(copyTarget, ec);
+        };
+        auto makeCopy = [&] {
+            if (fs::exists(copyTarget)) return;
+            TreeCopyStats stats;
+            TreeCopier::copyTree(tree.root, copyTarget, stats);
+        };
+        auto listAll = [&] {
+            MetadataCache metadata;
+            for (const auto& dir : tree.directories) metadata.listDirectory(dir);
+        };
+        NameMatcher matcher("_7", MatchMode::Substring);
+        auto search = [&] {
+            std::atomic<uintmax_t> hits{0};
+            ParallelWalker walker;
+            walker.walk(tree.root, [&](const WalkEntry& entry) {
+                if (matcher.matches(entry.name)) hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            });
+        };
+        auto copy = [&] {
+            TreeCopyStats stats;
+            TreeCopier::copyTree(tree.root, copyTarget, stats);
+        };
+        auto remove = [&] {
+            DeleteStats stats;
+            TreeDeleter::removeTree(copyTarget, stats);
+        };
+
+        std::string operations;
+        for (bool cold : {false, true}) {
+            std::cerr << "Benchmarking " << tree.name << (cold ? " (cold)" : " (warm)") << "...\n";
+            const std::string rows[] = {
+                report("list", cold, measure(tree, cold, nothing, listAll), entries, 0),
+                report("search", cold, measure(tree, cold, nothing, search), entries, 0),
+                report("copy", cold, measure(tree, cold, removeCopy, copy), entries, tree.bytes),
+                report("delete", cold, measure(tree, cold, makeCopy, remove), entries, 0),
+            };
+            for (const auto& row : rows) {
+                if (!operations.empty()) operations += ",\n";
+                operations += row;
+            }
+        }
+        removeCopy();
+
+        char header[256];
+        snprintf(header, sizeof(header),
+                 "    {\"tree\": \"%s\", \"files\": %ju, \"directories\": %zu, \"bytes\": %ju, \"operations\": [\n",
+                 tree.name.c_str(), tree.files, tree.directories.size(), tree.bytes);
+        return header + operations + "\n    ]}";
+    }
+
+    static std::string quoted(std::string_view text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    std::string benchCopyMethods(const Tree& tree) {
+        std::cerr << "Benchmarking copy methods...\n";
+        fs::path file = tree.root / "huge_0.bin";
+        fs::path target = workDir / "huge_0.bin.copy";
+        const CopyMethod methods[] = {CopyMethod::Reflink, CopyMethod::CopyFileRange,
+                                      CopyMethod::Sendfile, CopyMethod::ReadWrite};
+        std::string rows;
+        for (CopyMethod method : methods) {
+            std::vector<double> rates;
+            std::string failure;
+            for (int run = 0; run < runs && failure.empty(); run++) {
+                try {
+                    CopyResult result = CopyEngine::copyFile(file, target, method, false);
+                    rates.push_back(result.throughputMBps());
+                } catch (const fs::filesystem_error& e) {
+                    failure = e.code().message();
                 }
-                
-                std::cout << "║ Permissions: " << getPermissionString(fileStatus.permissions()) << "\n";
-                
-                auto ftime = fs::last_write_time(filePath);
-                auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                    ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
-                std::time_t cftime = std::chrono::system_clock::to_time_t(sctp);
-                
-                std::cout << "║ Modified:    " << std::ctime(&cftime);
-                std::cout << "╚════════════════════════════════════════════════════╝\n";
+                std::error_code ec;
+                fs::remove(target, ec);
             }
-        } catch (const fs::filesystem_error& e) {
-            std::cout << "\nError: " << e.what() << "\n";
+            if (!rows.empty()) rows += ",\n";
+            if (!failure.empty()) {
+                rows += "    {\"method\": " + quoted(CopyEngine::methodName(method)) +
+                        ", \"supported\": false, \"error\": " + quoted(failure) + "}";
+                continue;
+            }
+            std::sort(rates.begin(), rates.end());
+            char line[256];
+            snprintf(line, sizeof(line),
+                     "    {\"method\": \"%s\", \"supported\": true, \"best_mb_per_s\": %.1f, "
+                     "\"median_mb_per_s\": %.1f}",
+                     CopyEngine::methodName(method), rates.back(), rates[rates.size() / 2]);
+            rows += line;
         }
-        
-        std::cout << "\nPress Enter to continue...";
-        std::cin.get();
+        return rows;
     }
 
-    int getValidMenuChoice() {
-        int choice;
-        while (true) {
-            if (std::cin >> choice) {
-                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                return choice;
-            } else {
-                std::cin.clear();
-                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                std::cout << "\nInvalid input! Please enter a number: ";
+    std::string benchMatchers() {
+        size_t nameCount = static_cast<size_t>(1000000) * static_cast<size_t>(scale);
+        std::cerr << "Benchmarking name matchers...\n";
+        const char* stems[] = {"report", "IMG_", "build", "config", "Makefile", "data", "résumé", "notes", "core"};
+        const char* extensions[] = {".txt", ".log", ".cpp", ".JPG", ".json", ".tar.gz", "", ".o"};
+        std::string arena;
+        std::vector<std::pair<uint32_t, uint32_t>> names;
+        names.reserve(nameCount);
+        for (size_t i = 0; i < nameCount; i++) {
+            uint64_t value = next();
+            std::string name = std::string(stems[value % 9]) + "_" + std::to_string(value % 100000) +
+                               extensions[(value >> 20) % 8];
+            names.emplace_back(static_cast<uint32_t>(arena.size()), static_cast<uint32_t>(name.size()));
+            arena += name;
+        }
+
+        struct Case {
+            const char* label;
+            MatchMode mode;
+            const char* pattern;
+        };
+        const Case cases[] = {
+            {"string_view_find", MatchMode::Substring, "config_4"},
+            {"substring", MatchMode::Substring, "config_4"},
+            {"ignore_case", MatchMode::IgnoreCase, "RÉSUMÉ_4"},
+            {"glob", MatchMode::Glob, "IMG__*[0-4].JPG"},
+            {"regex", MatchMode::Regex, "^IMG__[0-9]+[0-4]\\.JPG$"},
+        };
+        std::string rows;
+        bool baseline = true;
+        for (const auto& test : cases) {
+            NameMatcher matcher(test.pattern, test.mode);
+            std::vector<double> times;
+            size_t hits = 0;
+            for (int run = 0; run < runs; run++) {
+                auto start = std::chrono::steady_clock::now();
+                hits = 0;
+                for (const auto& [offset, length] : names) {
+                    std::string_view name(arena.data() + offset, length);
+                    if (baseline ? name.find(test.pattern) != std::string_view::npos : matcher.matches(name)) hits++;
+                }
+                times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
             }
+            std::sort(times.begin(), times.end());
+            char line[128];
+            snprintf(line, sizeof(line), ", \"names\": %zu, \"matches\": %zu, \"p50_ns_per_name\": %.2f}",
+                     names.size(), hits, times[times.size() / 2] * 1e9 / static_cast<double>(std::max<size_t>(1, names.size())));
+            if (!rows.empty()) rows += ",\n";
+            rows += "    {\"matcher\": \"" + std::string(test.label) + "\", \"pattern\": " + quoted(test.pattern) + line;
+            baseline = false;
         }
+        return rows;
     }
 
-    void run() {
-        int choice;
-        
-        while (true) {
-            clearScreen();
-            displayHeader();
-            displayMenu();
-            
-            choice = getValidMenuChoice();
-            
-            switch (choice) {
-                case 1:
-                    listFiles();
-                    break;
-                case 2:
-                    changeDirectory();
-                    break;
-                case 3:
-                    createFile();
-                    break;
-                case 4:
-                    createDirectory();
-                    break;
-                case 5:
-                    copyFile();
-                    break;
-                case 6:
-                    moveFile();
-                    break;
-                case 7:
-                    deleteFile();
-                    break;
-                case 8:
-                    deleteDirectory();
-                    break;
-                case 9:
-                    searchFiles();
-                    break;
-                case 10:
-                    viewPermissions();
-                    break;
-                case 11:
-                    changePermissions();
-                    break;
-                case 12:
-                    viewFileDetails();
-                    break;
-                case 0:
-                    clearScreen();
-                    std::cout << "\n╔═══════════════════════════════════════════════╗\n";
-                    std::cout << "║  Thank you for using File Explorer!           ║\n";
-                    std::cout << "║  Goodbye!                                      ║\n";
-                    std::cout << "╚═══════════════════════════════════════════════╝\n\n";
-                    return;
-                default:
-                    std::cout << "\nInvalid choice! Please try again.\n";
-                    std::cout << "Press Enter to continue...";
-                    std::cin.get();
+    std::string benchFuzzy() {
+        size_t pathCount = static_cast<size_t>(1000000) * static_cast<size_t>(scale);
+        std::cerr << "Benchmarking fuzzy finder...\n";
+        const char* dirs[] = {"src", "include", "build", "docs", "assets", "tests", "vendor", "tools"};
+        const char* stems[] = {"report", "FileExplorer", "main", "config", "parser", "render", "index", "utils"};
+        const char* extensions[] = {".cpp", ".h", ".json", ".md", ".o", ".png", ".txt", ""};
+        std::vector<std::string> paths;
+        paths.reserve(pathCount);
+        for (size_t i = 0; i < pathCount; i++) {
+            uint64_t value = next();
+            paths.push_back(std::string(dirs[value % 8]) + "/module_" + std::to_string((value >> 8) % 500) + "/" +
+                            stems[(value >> 20) % 8] + "_" + std::to_string((value >> 24) % 10000) +
+                            extensions[(value >> 40) % 8]);
+        }
+        FuzzyCandidates candidates;
+        candidates.loadFromList(paths);
+        paths.clear();
+        FuzzyFinder finder(candidates);
+
+        const char* sessions[] = {"fileexpcpp", "src/mainh", "rendr42"};
+        std::string rows;
+        for (const char* session : sessions) {
+            std::string typed;
+            std::string keys;
+            double worst = 0;
+            double total = 0;
+            for (const char* c = session; *c; c++) {
+                typed += *c;
+                finder.setQuery(typed);
+                char key[32];
+                snprintf(key, sizeof(key), "%s%.3f", keys.empty() ? "" : ", ", finder.lastMilliseconds());
+                keys += key;
+                worst = std::max(worst, finder.lastMilliseconds());
+                total += finder.lastMilliseconds();
+            }
+            size_t matches = finder.matchCount();
+            double backspace = 0;
+            while (!typed.empty()) {
+                typed.pop_back();
+                finder.setQuery(typed);
+                backspace = std::max(backspace, finder.lastMilliseconds());
             }
+            char line[256];
+            snprintf(line, sizeof(line),
+                     ", \"candidates\": %zu, \"matches\": %zu, \"worst_key_ms\": %.3f, \"mean_key_ms\": %.3f, "
+                     "\"worst_backspace_ms\": %.3f, \"key_ms\": [",
+                     candidates.size(), matches, worst, total / static_cast<double>(strlen(session)), backspace);
+            if (!rows.empty()) rows += ",\n";
+            rows += "    {\"query\": " + quoted(session) + line + keys + "]}";
         }
+        return rows;
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "bench") {
+        return BenchmarkSuite::main(argc, argv);
+    }
+    if (argc >= 2) {
+        return CommandRunner::main(argc, argv);
+    }
+    
     FileExplorer explorer;
     explorer.run();
     return 0;